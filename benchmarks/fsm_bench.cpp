@@ -0,0 +1,569 @@
+// Micro-benchmarks for the state_machine hot paths, using only the standard
+// library. Results go to stdout as CSV (default) or JSON:
+//
+//   fsm_bench [--format=csv|json] [--filter=<substring>] [--min-time=<sec>]
+//
+// Each benchmark is calibrated until one run takes at least --min-time, then
+// repeated; the reported time is the median over repetitions.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <state_machine/ByteScanner.hpp>
+#include <state_machine/EdgeTransitionTable.hpp>
+#include <state_machine/EnumUtils.hpp>
+#include <state_machine/FSMPool.hpp>
+#include <state_machine/MachineDefinition.hpp>
+#include <state_machine/StateMachine.hpp>
+#include <state_machine/StaticStateMachine.hpp>
+#include <state_machine/SwitchStateMachine.hpp>
+#include <state_machine/TimerWheel.hpp>
+#include <state_machine/Trace.hpp>
+#include <state_machine/TransitionTable.hpp>
+
+namespace sm = state_machine;
+
+namespace {
+
+enum class State4 : std::uint8_t {
+  A,
+  B,
+  C,
+  D,
+  MAX_VALUE,
+};
+
+enum class State64 : std::uint8_t {
+  MAX_VALUE = 64,
+};
+
+enum class State256 : std::uint16_t {
+  MAX_VALUE = 256,
+};
+
+enum class Event16 : std::uint8_t {
+  MAX_VALUE = 16,
+};
+
+using Event = Event16;
+constexpr std::size_t EventCount = enum_utils::enum_size_v<Event>;
+
+// Keeps `value` alive without letting the compiler see through it.
+template <typename T> void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const T *sink;
+  sink = &value;
+#endif
+}
+
+struct Options {
+  bool json = false;
+  std::string_view filter;
+  double minTime = 0.1;
+  int repetitions = 5;
+};
+
+struct Result {
+  std::string name;
+  std::uint64_t iterations;
+  double nsPerOp;
+};
+
+class Runner {
+ public:
+  explicit Runner(const Options &options) : options_(options) {}
+
+  // `body(n)` must perform n operations.
+  void run(const std::string &name,
+           const std::function<void(std::uint64_t)> &body) {
+    if (!options_.filter.empty() &&
+        name.find(options_.filter) == std::string::npos) {
+      return;
+    }
+    std::uint64_t iterations = 1;
+    for (;;) {
+      const double seconds = time(body, iterations);
+      if (seconds >= options_.minTime || iterations >= (1ULL << 40)) {
+        break;
+      }
+      const double scale =
+          seconds > 0 ? std::min(10.0, 1.5 * options_.minTime / seconds)
+                      : 10.0;
+      iterations = std::max(iterations + 1,
+                            static_cast<std::uint64_t>(iterations * scale));
+    }
+    std::vector<double> samples;
+    for (int r = 0; r < options_.repetitions; ++r) {
+      samples.push_back(time(body, iterations) * 1e9 /
+                        static_cast<double>(iterations));
+    }
+    std::ranges::nth_element(samples, samples.begin() + samples.size() / 2);
+    results_.push_back({name, iterations, samples[samples.size() / 2]});
+  }
+
+  void report() const {
+    if (options_.json) {
+      std::println("{{\n  \"benchmarks\": [");
+      for (std::size_t i = 0; i < results_.size(); ++i) {
+        const auto &r = results_[i];
+        std::println("    {{\"name\": \"{}\", \"iterations\": {}, "
+                     "\"ns_per_op\": {:.4f}, \"ops_per_sec\": {:.0f}}}{}",
+                     r.name, r.iterations, r.nsPerOp, 1e9 / r.nsPerOp,
+                     i + 1 < results_.size() ? "," : "");
+      }
+      std::println("  ]\n}}");
+      return;
+    }
+    std::println("name,iterations,ns_per_op,ops_per_sec");
+    for (const auto &r : results_) {
+      std::println("{},{},{:.4f},{:.0f}", r.name, r.iterations, r.nsPerOp,
+                   1e9 / r.nsPerOp);
+    }
+  }
+
+ private:
+  static double time(const std::function<void(std::uint64_t)> &body,
+                     std::uint64_t iterations) {
+    const auto start = std::chrono::steady_clock::now();
+    body(iterations);
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+  }
+
+  Options options_;
+  std::vector<Result> results_;
+};
+
+template <typename S> constexpr std::size_t stateCount() {
+  return enum_utils::enum_size_v<S>;
+}
+
+// Every (state, event) cell defined, so no event is ever rejected.
+template <typename S> sm::TransitionTable<S, Event> makeTable(unsigned seed) {
+  std::mt19937 rng(seed);
+  sm::TransitionTable<S, Event> table{};
+  for (std::size_t s = 0; s < stateCount<S>(); ++s) {
+    for (std::size_t e = 0; e < EventCount; ++e) {
+      table.enable(static_cast<S>(s), static_cast<S>(rng() % stateCount<S>()),
+                   static_cast<Event>(e));
+    }
+  }
+  return table;
+}
+
+// Compile-time counterpart of makeTable(), for StaticFSM and SwitchFSM.
+template <typename S>
+constexpr sm::TransitionTable<S, Event> makeStaticTable() {
+  std::uint32_t x = 1;
+  sm::TransitionTable<S, Event> table{};
+  for (std::size_t s = 0; s < stateCount<S>(); ++s) {
+    for (std::size_t e = 0; e < EventCount; ++e) {
+      x = (x * 1664525U) + 1013904223U;
+      const auto to = static_cast<S>((x >> 8) % stateCount<S>());
+      table.enable(static_cast<S>(s), to, static_cast<Event>(e));
+    }
+  }
+  return table;
+}
+
+// Power-of-two sized so streams wrap with a mask.
+constexpr std::size_t StreamSize = 1 << 14;
+
+std::vector<Event> makeStream(bool random, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::vector<Event> events(StreamSize);
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    events[i] = static_cast<Event>(random ? rng() % EventCount
+                                          : i % EventCount);
+  }
+  return events;
+}
+
+enum class Hooks {
+  None,
+  Guard,
+  PureGuard,
+  Callbacks,
+  Both,
+};
+
+constexpr std::string_view hooksName(Hooks hooks) {
+  switch (hooks) {
+  case Hooks::None:
+    return "plain";
+  case Hooks::Guard:
+    return "guard";
+  case Hooks::PureGuard:
+    return "pure_guard";
+  case Hooks::Callbacks:
+    return "callbacks";
+  case Hooks::Both:
+    return "guard+callbacks";
+  }
+  return "?";
+}
+
+template <typename Machine>
+void configure(Machine &fsm, Hooks hooks, std::uint64_t &counter) {
+  using S = typename Machine::State;
+  fsm.init(makeTable<S>(1));
+  if (hooks == Hooks::Guard || hooks == Hooks::PureGuard ||
+      hooks == Hooks::Both) {
+    for (std::size_t s = 0; s < stateCount<S>(); ++s) {
+      fsm.attachTransitionGuard(
+          static_cast<S>(s), [](S, S, Event) { return true; },
+          hooks == Hooks::PureGuard ? sm::GuardPurity::Pure
+                                    : sm::GuardPurity::Impure);
+    }
+  }
+  if (hooks == Hooks::Callbacks || hooks == Hooks::Both) {
+    for (std::size_t s = 0; s < stateCount<S>(); ++s) {
+      fsm.attachOnEnterStateCallback(
+          static_cast<S>(s),
+          [&counter](sm::TransitionType, S, S, Event) { ++counter; });
+      fsm.attachOnExitStateCallback(
+          static_cast<S>(s),
+          [&counter](sm::TransitionType, S, S, Event) { ++counter; });
+    }
+  }
+}
+
+template <typename S> void benchProcessEvent(Runner &runner) {
+  const auto size = std::to_string(stateCount<S>());
+  for (const auto hooks :
+       {Hooks::None, Hooks::Guard, Hooks::PureGuard, Hooks::Callbacks,
+        Hooks::Both}) {
+    for (const bool random : {false, true}) {
+      const auto name = "process_event/" + std::string(hooksName(hooks)) +
+                        "/states=" + size + "/" +
+                        (random ? "random" : "sequential");
+      std::uint64_t counter = 0;
+      sm::FSM<S, Event> fsm(static_cast<S>(0));
+      configure(fsm, hooks, counter);
+      const auto events = makeStream(random, 2);
+      runner.run(name, [&](std::uint64_t n) {
+        for (std::uint64_t i = 0; i < n; ++i) {
+          auto r = fsm.processEvent(events[i & (StreamSize - 1)]);
+          doNotOptimize(r);
+        }
+        doNotOptimize(counter);
+      });
+    }
+  }
+
+  std::uint64_t counter = 0;
+  sm::FSM<S, Event> fsm(static_cast<S>(0));
+  configure(fsm, Hooks::None, counter);
+  const auto events = makeStream(true, 2);
+  runner.run("process_events/plain/states=" + size + "/random",
+             [&](std::uint64_t n) {
+               for (std::uint64_t done = 0; done < n;) {
+                 const auto count = static_cast<std::size_t>(
+                     std::min<std::uint64_t>(StreamSize, n - done));
+                 auto r = fsm.processEvents(std::span(events.data(), count));
+                 doNotOptimize(r);
+                 done += count;
+               }
+             });
+}
+
+// Compile-time tables: StaticFSM's constant-table load against SwitchFSM's
+// generated jump, plain and with an inlined Enter hook, on cyclic and
+// random streams.
+struct CountingHooks {
+  template <typename S> void onEnter(S, S, Event) noexcept { ++count; }
+  std::uint64_t count = 0;
+};
+
+template <typename Machine>
+void benchCompiledMachine(Runner &runner, const std::string &name,
+                          bool random) {
+  using S = typename Machine::State;
+  Machine fsm(static_cast<S>(0));
+  const auto events = makeStream(random, 2);
+  runner.run(name, [&](std::uint64_t n) {
+    for (std::uint64_t i = 0; i < n; ++i) {
+      auto r = fsm.processEvent(events[i & (StreamSize - 1)]);
+      doNotOptimize(r);
+    }
+    doNotOptimize(fsm);
+  });
+}
+
+template <typename S> void benchCompiled(Runner &runner) {
+  static constexpr auto Table = makeStaticTable<S>();
+  const auto states = "/states=" + std::to_string(stateCount<S>());
+  for (const bool random : {false, true}) {
+    const auto size = states + (random ? "/random" : "/cyclic");
+    benchCompiledMachine<sm::StaticFSM<Table>>(
+        runner, "process_event/static" + size, random);
+    benchCompiledMachine<sm::SwitchFSM<Table>>(
+        runner, "process_event/switch" + size, random);
+    benchCompiledMachine<sm::StaticFSM<Table, CountingHooks>>(
+        runner, "process_event/static+hooks" + size, random);
+    benchCompiledMachine<sm::SwitchFSM<Table, CountingHooks>>(
+        runner, "process_event/switch+hooks" + size, random);
+  }
+}
+
+// One action on every edge of an EdgeTransitionTable, against the
+// callbacks rows above.
+template <typename S> void benchEdgeAction(Runner &runner) {
+  using Table = sm::EdgeTransitionTable<S, Event>;
+  const auto plain = makeTable<S>(1);
+  Table table{};
+  for (std::size_t s = 0; s < stateCount<S>(); ++s) {
+    for (std::size_t e = 0; e < EventCount; ++e) {
+      table.enable(static_cast<S>(s),
+                   plain.lookup(static_cast<S>(s), static_cast<Event>(e)),
+                   static_cast<Event>(e), sm::NoEdgeHook, 1);
+    }
+  }
+  std::uint64_t counter = 0;
+  sm::FSM<S, Event, Table> fsm(static_cast<S>(0));
+  fsm.init(table);
+  (void)fsm.addEdgeAction([&counter](S, S, Event) { ++counter; });
+  const auto events = makeStream(true, 2);
+  runner.run("process_event/edge_action/states=" +
+                 std::to_string(stateCount<S>()) + "/random",
+             [&](std::uint64_t n) {
+               for (std::uint64_t i = 0; i < n; ++i) {
+                 auto r = fsm.processEvent(events[i & (StreamSize - 1)]);
+                 doNotOptimize(r);
+               }
+               doNotOptimize(counter);
+             });
+}
+
+template <typename S, sm::TraceClock Clock>
+void benchTrace(Runner &runner, std::string_view clock) {
+  using Tracing = sm::TraceInstrumentation<S, Event, 4096, Clock>;
+  sm::TraceBuffer<S, Event, 4096, Clock> trace;
+  std::uint64_t counter = 0;
+  sm::FSM<S, Event, sm::TransitionTable<S, Event>, Tracing> fsm(
+      static_cast<S>(0), Tracing(trace));
+  configure(fsm, Hooks::None, counter);
+  const auto events = makeStream(true, 2);
+  runner.run("process_event/trace=" + std::string(clock) +
+                 "/states=" + std::to_string(stateCount<S>()) + "/random",
+             [&](std::uint64_t n) {
+               for (std::uint64_t i = 0; i < n; ++i) {
+                 auto r = fsm.processEvent(events[i & (StreamSize - 1)]);
+                 doNotOptimize(r);
+               }
+             });
+}
+
+template <typename S> void benchConstruction(Runner &runner) {
+  const auto name =
+      "construct_init_enable/states=" + std::to_string(stateCount<S>());
+  runner.run(name, [](std::uint64_t n) {
+    for (std::uint64_t i = 0; i < n; ++i) {
+      sm::FSM<S, Event> fsm(static_cast<S>(0));
+      fsm.init();
+      for (std::size_t s = 0; s < stateCount<S>(); ++s) {
+        fsm.enableTransition(static_cast<S>(s),
+                             static_cast<S>((s + 1) % stateCount<S>()),
+                             static_cast<Event>(s % EventCount));
+      }
+      doNotOptimize(fsm);
+    }
+  });
+}
+
+// Many machines, each event to a random one: owned tables (FSM copies)
+// against one shared definition (FSMInstance).
+template <typename S> void benchMultiInstance(Runner &runner) {
+  const auto size = std::to_string(stateCount<S>());
+  for (const std::size_t machines : {std::size_t{16}, std::size_t{1024},
+                                     std::size_t{4096}}) {
+    const auto suffix = "/states=" + size +
+                        "/machines=" + std::to_string(machines);
+    std::vector<std::uint32_t> targets(StreamSize);
+    std::mt19937 rng(5);
+    for (auto &t : targets) {
+      t = static_cast<std::uint32_t>(rng() % machines);
+    }
+    const auto events = makeStream(true, 3);
+
+    sm::FSM<S, Event> prototype(static_cast<S>(0));
+    prototype.init(makeTable<S>(1));
+    std::vector<sm::FSM<S, Event>> owned(machines, prototype);
+    runner.run("multi_instance/owned" + suffix, [&](std::uint64_t n) {
+      for (std::uint64_t i = 0; i < n; ++i) {
+        const auto k = i & (StreamSize - 1);
+        auto r = owned[targets[k]].processEvent(events[k]);
+        doNotOptimize(r);
+      }
+    });
+
+    const sm::MachineDefinition<S, Event> definition(makeTable<S>(1));
+    std::vector<sm::FSMInstance<S, Event>> shared(
+        machines, sm::FSMInstance<S, Event>(definition, static_cast<S>(0)));
+    runner.run("multi_instance/shared" + suffix, [&](std::uint64_t n) {
+      for (std::uint64_t i = 0; i < n; ++i) {
+        const auto k = i & (StreamSize - 1);
+        auto r = shared[targets[k]].processEvent(events[k]);
+        doNotOptimize(r);
+      }
+    });
+  }
+}
+
+template <typename S> void benchPool(Runner &runner) {
+  const auto name = "pool_step/states=" + std::to_string(stateCount<S>()) +
+                    "/machines=4096";
+  constexpr std::size_t machines = 4096;
+  sm::FSMPool<S, Event> pool(makeTable<S>(1), machines, static_cast<S>(0));
+  const auto events = makeStream(true, 4);
+  runner.run(name, [&](std::uint64_t n) {
+    for (std::uint64_t done = 0; done < n;) {
+      const auto count = static_cast<std::size_t>(
+          std::min<std::uint64_t>(machines, n - done));
+      pool.step(std::span(events.data(), count));
+      doNotOptimize(pool.states().data());
+      done += count;
+    }
+  });
+}
+
+// Re-arming a state timeout (cancel + arm), and expiring many timers:
+// 65536 timers spread over 4096 ticks, so each tick fires a batch of 16.
+void benchTimers(Runner &runner) {
+  constexpr std::size_t Timers = 1 << 16;
+  constexpr std::uint64_t Spread = 4096;
+  sm::TimerWheel wheel;
+  std::vector<sm::TimerNode> nodes(Timers);
+  std::uint64_t fired = 0;
+  for (auto &node : nodes) {
+    node = sm::TimerNode(
+        [](sm::TimerNode &, void *context) {
+          ++*static_cast<std::uint64_t *>(context);
+        },
+        &fired);
+  }
+  std::mt19937 rng(7);
+  std::vector<std::uint32_t> delays(Timers);
+  for (auto &d : delays) {
+    d = static_cast<std::uint32_t>(1 + (rng() % Spread));
+  }
+
+  runner.run("timer_wheel/rearm/timers=65536", [&](std::uint64_t n) {
+    for (std::uint64_t i = 0; i < n; ++i) {
+      const auto k = i & (Timers - 1);
+      wheel.armAfter(nodes[k], delays[k]);
+    }
+    doNotOptimize(wheel.size());
+  });
+
+  runner.run("timer_wheel/expire/timers=65536", [&](std::uint64_t n) {
+    for (std::uint64_t done = 0; done < n;) {
+      for (std::size_t k = 0; k < Timers; ++k) {
+        wheel.armAfter(nodes[k], delays[k]);
+      }
+      const auto before = fired;
+      (void)wheel.advance(wheel.now() + Spread);
+      done += fired - before;
+    }
+    doNotOptimize(fired);
+  });
+}
+
+void benchScanner(Runner &runner) {
+  const sm::ByteScanner<State64, Event> scanner(
+      makeTable<State64>(1), [] {
+        sm::ByteEventMap<Event> map{};
+        for (std::size_t b = 0; b < 256; ++b) {
+          map.map(static_cast<std::byte>(b), static_cast<Event>(b % 16));
+        }
+        return map;
+      }());
+  std::vector<std::byte> input(1 << 16);
+  std::mt19937 rng(6);
+  for (auto &b : input) {
+    b = static_cast<std::byte>(rng());
+  }
+
+  runner.run("scan/states=64/streams=1", [&](std::uint64_t n) {
+    for (std::uint64_t done = 0; done < n;) {
+      const auto count = static_cast<std::size_t>(
+          std::min<std::uint64_t>(input.size(), n - done));
+      auto r = scanner.scan(std::span(input).first(count), State64{});
+      doNotOptimize(r);
+      done += count;
+    }
+  });
+  runner.run("scan/states=64/streams=8", [&](std::uint64_t n) {
+    constexpr std::size_t Lanes = 8;
+    std::array<std::span<const std::byte>, Lanes> inputs;
+    for (std::uint64_t done = 0; done < n;) {
+      const auto chunk = static_cast<std::size_t>(std::max<std::uint64_t>(
+          1, std::min<std::uint64_t>(input.size(), n - done) / Lanes));
+      for (std::size_t k = 0; k < Lanes; ++k) {
+        inputs[k] = std::span(input).subspan(
+            (k * chunk) % (input.size() - chunk + 1), chunk);
+      }
+      auto r = scanner.scanInterleaved<Lanes>(inputs, {});
+      doNotOptimize(r);
+      done += chunk * Lanes;
+    }
+  });
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    if (arg == "--format=json") {
+      options.json = true;
+    } else if (arg == "--format=csv") {
+      options.json = false;
+    } else if (arg.starts_with("--filter=")) {
+      options.filter = arg.substr(9);
+    } else if (arg.starts_with("--min-time=")) {
+      options.minTime = std::stod(std::string(arg.substr(11)));
+    } else {
+      std::println(stderr,
+                   "usage: {} [--format=csv|json] [--filter=<substring>] "
+                   "[--min-time=<seconds>]",
+                   argv[0]);
+      return 2;
+    }
+  }
+
+  Runner runner(options);
+  benchProcessEvent<State4>(runner);
+  benchProcessEvent<State64>(runner);
+  benchProcessEvent<State256>(runner);
+  benchCompiled<State4>(runner);
+  benchCompiled<State64>(runner);
+  benchEdgeAction<State64>(runner);
+  benchTrace<State64, sm::TraceClock::Sequence>(runner, "sequence");
+  benchTrace<State64, sm::DefaultTraceClock>(runner, "clock");
+  benchConstruction<State4>(runner);
+  benchConstruction<State64>(runner);
+  benchConstruction<State256>(runner);
+  benchMultiInstance<State4>(runner);
+  benchMultiInstance<State64>(runner);
+  benchPool<State4>(runner);
+  benchPool<State64>(runner);
+  benchTimers(runner);
+  benchScanner(runner);
+  runner.report();
+  return 0;
+}
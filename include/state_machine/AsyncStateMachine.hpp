@@ -0,0 +1,129 @@
+#pragma once
+
+#include "MpscQueue.hpp"
+#include "Types.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+namespace state_machine {
+
+// Asynchronous front-end for a single-threaded machine (FSM, FSMInstance,
+// StaticFSM, ...). Any thread may post() events into a bounded lock-free
+// MPSC queue; one consumer feeds them to Machine::processEvent() in order,
+// either a dedicated dispatcher thread (start()) or the caller of drain().
+//
+// Each result is delivered to the completion handler on the consumer
+// thread. Configure the machine before start() and do not touch it while
+// the dispatcher runs.
+template <typename Machine, std::size_t Capacity = 1024> class AsyncFSM {
+ public:
+  using State = typename Machine::State;
+  using Event = typename Machine::Event;
+  using Result = std::expected<State, ProcessEventErr>;
+  using CompletionHandler = std::function<void(Event, Result)>;
+
+  explicit AsyncFSM(Machine machine, CompletionHandler onComplete = {})
+      : machine_(std::move(machine)), onComplete_(std::move(onComplete)) {}
+
+  AsyncFSM(const AsyncFSM &) = delete;
+  AsyncFSM &operator=(const AsyncFSM &) = delete;
+
+  ~AsyncFSM() { stop(); }
+
+  // Returns false when the queue is full; the event is dropped.
+  bool post(Event event) noexcept {
+    if (!queue_.tryPush(event)) {
+      return false;
+    }
+    // Pairs with the fence in run(): either the dispatcher sees the event
+    // before sleeping, or we see it sleeping and wake it.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed)) {
+      wake();
+    }
+    return true;
+  }
+
+  // Processes up to `maxEvents` queued events on the calling thread and
+  // returns how many ran. Only valid while the dispatcher is not running.
+  std::size_t drain(std::size_t maxEvents = Capacity) {
+    std::size_t processed = 0;
+    while (processed < maxEvents) {
+      const auto event = queue_.tryPop();
+      if (!event) {
+        break;
+      }
+      auto result = machine_.processEvent(*event);
+      if (onComplete_) {
+        onComplete_(*event, std::move(result));
+      }
+      ++processed;
+    }
+    return processed;
+  }
+
+  // Launches the dispatcher thread. No-op if it is already running.
+  void start() {
+    if (!dispatcher_.joinable()) {
+      dispatcher_ = std::jthread([this](std::stop_token st) { run(st); });
+    }
+  }
+
+  // Stops the dispatcher after it has drained every event posted so far.
+  void stop() {
+    if (dispatcher_.joinable()) {
+      dispatcher_.request_stop();
+      wake();
+      dispatcher_.join();
+    }
+  }
+
+  Machine &machine() noexcept { return machine_; }
+  const Machine &machine() const noexcept { return machine_; }
+
+ private:
+  static constexpr std::size_t BatchSize = 64;
+
+  void wake() noexcept {
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_one();
+  }
+
+  void run(std::stop_token st) {
+    for (;;) {
+      if (drain(BatchSize) > 0) {
+        continue;
+      }
+      if (st.stop_requested()) {
+        drain();
+        if (queue_.empty()) {
+          return;
+        }
+        continue;
+      }
+      const auto seen = signal_.load(std::memory_order_acquire);
+      sleeping_.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (queue_.empty() && !st.stop_requested()) {
+        signal_.wait(seen, std::memory_order_acquire);
+      }
+      sleeping_.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  Machine machine_;
+  CompletionHandler onComplete_;
+  MpscQueue<Event, Capacity> queue_;
+  std::atomic<bool> sleeping_{false};
+  std::atomic<std::uint32_t> signal_{0};
+  std::jthread dispatcher_;
+};
+
+} // namespace state_machine
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "Types.hpp"
+
+#include <coroutine>
+#include <expected>
+#include <optional>
+#include <utility>
+
+namespace state_machine {
+
+// A completed transition, as seen by an awaiting coroutine.
+template <StateID S, EventID E> struct Transition {
+  S from;
+  S to;
+  E event;
+
+  constexpr bool operator==(const Transition &) const = default;
+};
+
+template <typename Machine> class AwaitableFSM;
+
+namespace detail {
+
+// Intrusive doubly-linked waiter node. Nodes live inside the awaiters, i.e. in
+// the suspended coroutine's frame, so waiting never allocates.
+template <typename S, typename E> struct WaiterNode {
+  struct List {
+    WaiterNode *head = nullptr;
+    WaiterNode *tail = nullptr;
+
+    bool empty() const noexcept { return head == nullptr; }
+
+    void pushBack(WaiterNode *node) noexcept {
+      node->list = this;
+      node->prev = tail;
+      node->next = nullptr;
+      (tail ? tail->next : head) = node;
+      tail = node;
+    }
+
+    void remove(WaiterNode *node) noexcept {
+      (node->prev ? node->prev->next : head) = node->next;
+      (node->next ? node->next->prev : tail) = node->prev;
+      node->list = nullptr;
+      node->prev = node->next = nullptr;
+    }
+  };
+
+  WaiterNode() = default;
+  WaiterNode(const WaiterNode &) = delete;
+  WaiterNode &operator=(const WaiterNode &) = delete;
+
+  // A coroutine destroyed while suspended takes its node off the list.
+  ~WaiterNode() {
+    if (list) {
+      list->remove(this);
+    }
+  }
+
+  std::coroutine_handle<> handle{};
+  std::optional<S> target{};
+  std::optional<Transition<S, E>> transition{};
+  List *list = nullptr;
+  WaiterNode *prev = nullptr;
+  WaiterNode *next = nullptr;
+};
+
+} // namespace detail
+
+// Coroutine front-end for a single-threaded machine (FSM, FSMInstance,
+// InlineFSM, StaticFSM, ...). Coroutines suspend on
+//
+//   co_await fsm.until(State::Active);
+//   auto t = co_await fsm.nextTransition();
+//
+// and are resumed inline by processEvent(), after the transition has
+// committed and its Enter callbacks have run. A waiter registered while
+// another is being resumed waits for the next transition, so awaiting in a
+// loop never sees the same transition twice.
+//
+// Like the wrapped machine, AwaitableFSM is not thread-safe; combine it with
+// AsyncFSM to resume coroutines on a dispatcher thread.
+template <typename Machine> class AwaitableFSM {
+ public:
+  using State = typename Machine::State;
+  using Event = typename Machine::Event;
+  using Result = std::expected<State, ProcessEventErr>;
+
+ private:
+  using Node = detail::WaiterNode<State, Event>;
+
+ public:
+  // Resumes when the machine enters `target`; completes immediately if it is
+  // already there. Yields the entering transition, or nullopt if none.
+  class StateAwaiter : Node {
+   public:
+    StateAwaiter(AwaitableFSM &fsm, State target) noexcept : fsm_(fsm) {
+      this->target = target;
+    }
+
+    bool await_ready() const noexcept {
+      return fsm_.machine_.getCurrentState() == *this->target;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+      this->handle = handle;
+      fsm_.waiters_.pushBack(this);
+    }
+
+    std::optional<Transition<State, Event>> await_resume() const noexcept {
+      return this->transition;
+    }
+
+   private:
+    AwaitableFSM &fsm_;
+  };
+
+  // Resumes on the next successful transition (self-loops included).
+  class TransitionAwaiter : Node {
+   public:
+    explicit TransitionAwaiter(AwaitableFSM &fsm) noexcept : fsm_(fsm) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+      this->handle = handle;
+      fsm_.waiters_.pushBack(this);
+    }
+
+    Transition<State, Event> await_resume() const noexcept {
+      return *this->transition;
+    }
+
+   private:
+    AwaitableFSM &fsm_;
+  };
+
+  explicit AwaitableFSM(Machine machine) : machine_(std::move(machine)) {}
+
+  AwaitableFSM(const AwaitableFSM &) = delete;
+  AwaitableFSM &operator=(const AwaitableFSM &) = delete;
+
+  StateAwaiter until(State target) noexcept { return {*this, target}; }
+
+  TransitionAwaiter nextTransition() noexcept {
+    return TransitionAwaiter{*this};
+  }
+
+  // Runs the event through the machine, then resumes every waiter the
+  // transition satisfies, in the order they started waiting. Rejected
+  // events resume nobody.
+  Result processEvent(Event event) {
+    const State from = machine_.getCurrentState();
+    auto result = machine_.processEvent(event);
+    if (result) {
+      notify({from, *result, event});
+    }
+    return result;
+  }
+
+  State getCurrentState() const { return machine_.getCurrentState(); }
+
+  bool hasWaiters() const noexcept {
+    return !waiters_.empty() || !ready_.empty();
+  }
+
+  Machine &machine() noexcept { return machine_; }
+  const Machine &machine() const noexcept { return machine_; }
+
+ private:
+  void notify(const Transition<State, Event> &transition) {
+    // Move matches to ready_ first: resumed coroutines may await again (onto
+    // waiters_) or be destroyed, and must not disturb this walk.
+    for (Node *node = waiters_.head; node != nullptr;) {
+      Node *next = node->next;
+      if (!node->target || *node->target == transition.to) {
+        node->transition = transition;
+        waiters_.remove(node);
+        ready_.pushBack(node);
+      }
+      node = next;
+    }
+    while (!ready_.empty()) {
+      Node *node = ready_.head;
+      ready_.remove(node);
+      node->handle.resume();
+    }
+  }
+
+  Machine machine_;
+  typename Node::List waiters_{};
+  typename Node::List ready_{};
+};
+
+} // namespace state_machine
@@ -0,0 +1,276 @@
+#pragma once
+
+#include "EnumUtils.hpp"
+#include "TransitionTable.hpp"
+#include "Types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace state_machine {
+
+// Maps each input byte to an event; unmapped bytes (E::MAX_VALUE) stop a
+// scan like a missing transition would. Chainable and constexpr, like
+// TransitionTable.
+template <EventID E> class ByteEventMap {
+ public:
+  constexpr ByteEventMap() { events_.fill(E::MAX_VALUE); }
+
+  constexpr ByteEventMap &map(std::byte byte, E event) {
+    events_[std::to_integer<std::size_t>(byte)] = event;
+    return *this;
+  }
+
+  // Maps every byte in [first, last].
+  constexpr ByteEventMap &mapRange(std::byte first, std::byte last, E event) {
+    for (auto b = std::to_integer<std::size_t>(first);
+         b <= std::to_integer<std::size_t>(last); ++b) {
+      events_[b] = event;
+    }
+    return *this;
+  }
+
+  constexpr E lookup(std::byte byte) const noexcept {
+    return events_[std::to_integer<std::size_t>(byte)];
+  }
+
+ private:
+  std::array<E, 256> events_{};
+};
+
+enum class ScanStop {
+  // Every input byte was consumed; feed the next chunk from `state`.
+  Exhausted,
+  // The byte at `position` has no transition (or no event) from `state`.
+  NoTransition,
+  // The byte before `position` entered the accepting state `state`.
+  Accepted,
+};
+
+template <StateID S> struct ScanResult {
+  std::size_t position;
+  S state;
+  ScanStop stop;
+};
+
+// Runs a transition table as a byte-stream recognizer. The byte-to-event
+// map is fused into the table at construction, giving one narrow cell per
+// (state, byte), so the scan loop is a single load per byte with no error
+// objects.
+//
+// Input is scanned in place and may arrive in chunks of any size: pass the
+// state of an Exhausted result to the next scan(). Guards and callbacks of
+// the machine the table came from are not run.
+template <StateID S, EventID E> class ByteScanner {
+ public:
+  using State = S;
+  using Event = E;
+
+  template <TransitionTableBackend Table>
+    requires std::same_as<typename Table::State, S> &&
+             std::same_as<typename Table::Event, E>
+  ByteScanner(const Table &table, const ByteEventMap<E> &events,
+              std::span<const S> accepting = {})
+      : cells_(StateSize * 256, Sentinel) {
+    for (std::size_t s = 0; s < StateSize; ++s) {
+      for (std::size_t b = 0; b < 256; ++b) {
+        const E event = events.lookup(static_cast<std::byte>(b));
+        if (event == E::MAX_VALUE) {
+          continue;
+        }
+        const S next = table.lookup(static_cast<S>(s), event);
+        if (next != S::MAX_VALUE) {
+          cells_[(s * 256) + b] = static_cast<Cell>(next);
+        }
+      }
+    }
+    for (const S s : accepting) {
+      accepting_[static_cast<std::size_t>(s)] = true;
+      stops_[static_cast<std::size_t>(s)] = true;
+    }
+    stops_[Sentinel] = true;
+  }
+
+  // Consumes bytes from `state` until the input ends, a byte has no
+  // transition, or an accepting state is entered.
+  ScanResult<S> scan(std::span<const std::byte> input, S state) const noexcept {
+    const Cell *cells = cells_.data();
+    auto current = static_cast<Cell>(state);
+    for (std::size_t i = 0; i < input.size(); ++i) {
+      const Cell next =
+          cells[(static_cast<std::size_t>(current) * 256) +
+                std::to_integer<std::size_t>(input[i])];
+      if (next == Sentinel) {
+        return {i, static_cast<S>(current), ScanStop::NoTransition};
+      }
+      current = next;
+      if (accepting_[current]) {
+        return {i + 1, static_cast<S>(current), ScanStop::Accepted};
+      }
+    }
+    return {input.size(), static_cast<S>(current), ScanStop::Exhausted};
+  }
+
+  // Advances K independent streams in one interleaved loop; results match K
+  // separate scan() calls. A single stream is a chain of dependent loads,
+  // so interleaving lets the CPU overlap K of them. 4-16 streams usually
+  // saturate the load ports.
+  template <std::size_t K>
+    requires(K >= 1 && K <= 64)
+  std::array<ScanResult<S>, K>
+  scanInterleaved(const std::array<std::span<const std::byte>, K> &inputs,
+                  const std::array<S, K> &states) const noexcept {
+    std::array<ScanResult<S>, K> results{};
+    scanLanes<K>(inputs.data(), states.data(), results.data(), K);
+    return results;
+  }
+
+  // Any number of streams, K at a time: scans inputs[i] from
+  // results[i].state and overwrites results[i]. Both spans must have the
+  // same size.
+  template <std::size_t K = 8>
+    requires(K >= 1 && K <= 64)
+  void scanInterleaved(std::span<const std::span<const std::byte>> inputs,
+                       std::span<ScanResult<S>> results) const noexcept {
+    std::array<S, K> states{};
+    for (std::size_t first = 0; first < inputs.size(); first += K) {
+      const auto count = std::min(K, inputs.size() - first);
+      for (std::size_t k = 0; k < count; ++k) {
+        states[k] = results[first + k].state;
+      }
+      scanLanes<K>(inputs.data() + first, states.data(),
+                   results.data() + first, count);
+    }
+  }
+
+  bool isAccepting(S state) const noexcept {
+    return accepting_[static_cast<std::size_t>(state)];
+  }
+
+  // Next state for `byte`, or S::MAX_VALUE.
+  S next(S state, std::byte byte) const noexcept {
+    const Cell cell = cells_[(static_cast<std::size_t>(state) * 256) +
+                             std::to_integer<std::size_t>(byte)];
+    return cell == Sentinel ? S::MAX_VALUE : static_cast<S>(cell);
+  }
+
+ private:
+  static constexpr auto StateSize = enum_utils::enum_size_v<S>;
+
+  using Cell = enum_utils::enum_index_t<S>;
+  static constexpr auto Sentinel = static_cast<Cell>(StateSize);
+
+  // Steps every live lane in lockstep over the bytes all of them still
+  // have. A step that stops any lane (no transition, accepting state) ends
+  // the fast loop; that step is then applied lane by lane, finished lanes
+  // drop out, and the loop resumes.
+  template <std::size_t K>
+  void scanLanes(const std::span<const std::byte> *inputs, const S *states,
+                 ScanResult<S> *results, std::size_t count) const noexcept {
+    const Cell *cells = cells_.data();
+    std::array<Cell, K> current{};
+    std::array<Cell, K> next{};
+    std::array<const std::byte *, K> cursor{};
+    std::array<std::size_t, K> remaining{};
+    std::array<std::size_t, K> live{};
+    std::size_t liveCount = 0;
+
+    const auto finish = [&](std::size_t lane, ScanStop stop) {
+      results[lane] = {inputs[lane].size() - remaining[lane],
+                       static_cast<S>(current[lane]), stop};
+    };
+
+    for (std::size_t lane = 0; lane < count; ++lane) {
+      current[lane] = static_cast<Cell>(states[lane]);
+      cursor[lane] = inputs[lane].data();
+      remaining[lane] = inputs[lane].size();
+      if (remaining[lane] == 0) {
+        finish(lane, ScanStop::Exhausted);
+      } else {
+        live[liveCount++] = lane;
+      }
+    }
+
+    while (liveCount != 0) {
+      std::size_t steps = remaining[live[0]];
+      for (std::size_t j = 1; j < liveCount; ++j) {
+        steps = std::min(steps, remaining[live[j]]);
+      }
+
+      std::size_t i = 0;
+      if (liveCount == K) {
+        // All lanes live: fully unrolled so every lane's state stays in a
+        // register.
+        for (; i < steps; ++i) {
+          bool stop = false;
+          [&]<std::size_t... L>(std::index_sequence<L...>) {
+            ((next[L] = cells[(static_cast<std::size_t>(current[L]) * 256) +
+                              std::to_integer<std::size_t>(cursor[L][i])],
+              stop |= stops_[next[L]]),
+             ...);
+          }(std::make_index_sequence<K>{});
+          if (stop) {
+            break;
+          }
+          current = next;
+        }
+      } else {
+        for (; i < steps; ++i) {
+          bool stop = false;
+          for (std::size_t j = 0; j < liveCount; ++j) {
+            const auto lane = live[j];
+            next[lane] =
+                cells[(static_cast<std::size_t>(current[lane]) * 256) +
+                      std::to_integer<std::size_t>(cursor[lane][i])];
+            stop |= stops_[next[lane]];
+          }
+          if (stop) {
+            break;
+          }
+          for (std::size_t j = 0; j < liveCount; ++j) {
+            current[live[j]] = next[live[j]];
+          }
+        }
+      }
+
+      std::size_t kept = 0;
+      for (std::size_t j = 0; j < liveCount; ++j) {
+        const auto lane = live[j];
+        cursor[lane] += i;
+        remaining[lane] -= i;
+        if (i < steps) {
+          if (next[lane] == Sentinel) {
+            finish(lane, ScanStop::NoTransition);
+            continue;
+          }
+          current[lane] = next[lane];
+          ++cursor[lane];
+          --remaining[lane];
+          if (accepting_[current[lane]]) {
+            finish(lane, ScanStop::Accepted);
+            continue;
+          }
+        }
+        if (remaining[lane] == 0) {
+          finish(lane, ScanStop::Exhausted);
+          continue;
+        }
+        live[kept++] = lane;
+      }
+      liveCount = kept;
+    }
+  }
+
+  std::vector<Cell> cells_;
+  std::array<bool, StateSize> accepting_{};
+  // Cells that end a scan: the sentinel and accepting states.
+  std::array<bool, StateSize + 1> stops_{};
+};
+
+} // namespace state_machine
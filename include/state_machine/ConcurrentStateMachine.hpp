@@ -0,0 +1,130 @@
+#pragma once
+
+#include "EnumUtils.hpp"
+#include "MachineDefinition.hpp"
+#include "TransitionTable.hpp"
+#include "Types.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <expected>
+#include <thread>
+
+namespace state_machine {
+
+// Machine whose current state may be read and advanced from several threads.
+// It borrows an immutable MachineDefinition (as FSMInstance does) and keeps
+// the state in one atomic word.
+//
+// Without guards or callbacks a transition is a single compare-and-swap of
+// the state, so processEvent() is lock-free. With hooks, the thread whose
+// CAS sets an in-transition bit next to the current state owns the
+// transition:
+// - Only the owner evaluates the guard, once; other threads' events wait
+//   (spinning) until it finishes, then look up against the state it left.
+//   Guards therefore never run concurrently with each other, nor with Exit
+//   callbacks or edge actions.
+// - Exit callbacks and the edge action run on the owner before the new
+//   state is published; readers meanwhile still see the old state.
+// - Enter callbacks run after the new state is published and the bit is
+//   cleared, so one transition's Enter callbacks can interleave with the
+//   next owner's guard, Exit callbacks and action on another thread; by
+//   then the state may already have moved on.
+// Guards, Exit callbacks and actions must not process events on the same
+// machine (they would wait for themselves); Enter callbacks may.
+template <StateID S, EventID E, typename Table = TransitionTable<S, E>>
+class ConcurrentFSM {
+ public:
+  using Word = std::uint32_t;
+
+  static_assert(std::atomic<Word>::is_always_lock_free);
+  static_assert(enum_utils::enum_size_v<S> < (Word{1} << 31),
+                "state index must leave room for the in-transition bit");
+
+  ConcurrentFSM(const MachineDefinition<S, E, Table> &definition,
+                S initial) noexcept
+      : definition_(&definition), state_(toWord(initial)) {}
+
+  ConcurrentFSM(const ConcurrentFSM &) = delete;
+  ConcurrentFSM &operator=(const ConcurrentFSM &) = delete;
+
+  std::expected<S, ProcessEventErr> processEvent(E event) {
+    const bool hooks = definition_->hasHooks();
+    auto observed = state_.load(std::memory_order_acquire);
+    for (;;) {
+      if ((observed & InTransition) != 0) {
+        std::this_thread::yield();
+        observed = state_.load(std::memory_order_acquire);
+        continue;
+      }
+      const auto currentState = static_cast<S>(observed);
+      const auto edge = definition_->computeEdge(currentState, event);
+      const S nextState = edge.next;
+      if (nextState == S::MAX_VALUE) {
+        return std::unexpected(ProcessEventErr::NoNextStateFound);
+      }
+      if (!hooks) {
+        if (state_.compare_exchange_weak(
+                observed, toWord(nextState), std::memory_order_acq_rel,
+                std::memory_order_acquire)) {
+          return nextState;
+        }
+        continue;
+      }
+      if (!state_.compare_exchange_weak(
+              observed, observed | InTransition, std::memory_order_acquire,
+              std::memory_order_acquire)) {
+        continue;
+      }
+      return runClaimed(currentState, edge, event, observed);
+    }
+  }
+
+  // Never blocks; relaxed loads suit polling where ordering with other
+  // memory does not matter. During a transition this is still the state
+  // being left.
+  S getCurrentState(
+      std::memory_order order = std::memory_order_acquire) const noexcept {
+    return static_cast<S>(state_.load(order) & ~InTransition);
+  }
+
+  const MachineDefinition<S, E, Table> &definition() const noexcept {
+    return *definition_;
+  }
+
+ private:
+  static constexpr Word InTransition = Word{1} << 31;
+
+  static constexpr Word toWord(S state) noexcept {
+    return static_cast<Word>(state);
+  }
+
+  // Runs with the in-transition bit set by this thread; `claimed` is the
+  // word it replaced. A throwing guard, callback or action releases the
+  // machine in its old state.
+  template <typename Edge>
+  std::expected<S, ProcessEventErr> runClaimed(S currentState,
+                                               const Edge &edge, E event,
+                                               Word claimed) {
+    const S nextState = edge.next;
+    try {
+      if (!definition_->allowsTransition(currentState, edge, event)) {
+        state_.store(claimed, std::memory_order_release);
+        return std::unexpected(ProcessEventErr::TransitionForbidden);
+      }
+      definition_->notifyExit(currentState, nextState, event);
+      definition_->runAction(currentState, edge, event);
+    } catch (...) {
+      state_.store(claimed, std::memory_order_release);
+      throw;
+    }
+    state_.store(toWord(nextState), std::memory_order_release);
+    definition_->notifyEnter(currentState, nextState, event);
+    return nextState;
+  }
+
+  const MachineDefinition<S, E, Table> *definition_;
+  std::atomic<Word> state_;
+};
+
+} // namespace state_machine
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "EnumUtils.hpp"
+#include "TransitionTable.hpp"
+#include "Types.hpp"
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+namespace state_machine {
+
+// Index of a per-edge guard or action registered with a MachineDefinition
+// (see MachineDefinition::addEdgeGuard()). Ids are assigned 1, 2, ... in
+// registration order; NoEdgeHook marks an edge without one.
+using EdgeHookId = std::uint16_t;
+inline constexpr EdgeHookId NoEdgeHook = 0;
+
+// Everything dispatch needs about one (state, event) cell.
+template <StateID S> struct TransitionEdge {
+  S next;
+  EdgeHookId guard = NoEdgeHook;
+  EdgeHookId action = NoEdgeHook;
+
+  constexpr bool operator==(const TransitionEdge &) const = default;
+};
+
+// Dense table whose cells carry a guard id and an action id next to the
+// target state, so one load in MachineDefinition::processEvent() yields the
+// whole edge. Each cell is enum_index_t<S> plus two 16-bit ids (6 bytes for
+// up to 255 states), against one byte for TransitionTable: pick it when the
+// per-edge hooks replace branching on the event inside state callbacks.
+//
+// Like TransitionTable it is structural and constexpr-buildable; since ids
+// are assigned in registration order, a constexpr table can name them
+// before the callables are registered:
+//
+//   constexpr auto table = EdgeTransitionTable<State, Event>{}.enable(
+//       State::Idle, State::Active, Event::Start, /*guard=*/1, /*action=*/1);
+template <StateID S, EventID E> struct EdgeTransitionTable {
+  using State = S;
+  using Event = E;
+
+  static constexpr auto StateSize = enum_utils::enum_size_v<S>;
+  static constexpr auto EventSize = enum_utils::enum_size_v<E>;
+  static constexpr auto CellCount = StateSize * EventSize;
+
+  struct Cell {
+    enum_utils::enum_index_t<S> next;
+    EdgeHookId guard;
+    EdgeHookId action;
+
+    friend constexpr bool operator==(const Cell &, const Cell &) = default;
+  };
+
+  // Public only so the type stays structural; use the member functions.
+  std::array<Cell, CellCount> cells = emptyCells();
+
+  constexpr EdgeTransitionTable &
+  enable(S from, S to, E onEvent, EdgeHookId guard = NoEdgeHook,
+         EdgeHookId action = NoEdgeHook) noexcept {
+    cells[cellIndex(from, onEvent)] = {
+        static_cast<enum_utils::enum_index_t<S>>(to), guard, action};
+    return *this;
+  }
+
+  constexpr EdgeTransitionTable &disable(S from, E onEvent) noexcept {
+    cells[cellIndex(from, onEvent)] = SentinelCell;
+    return *this;
+  }
+
+  constexpr void clear() noexcept { cells = emptyCells(); }
+
+  constexpr S lookup(S state, E event) const noexcept {
+    return static_cast<S>(cells[cellIndex(state, event)].next);
+  }
+
+  constexpr TransitionEdge<S> edge(S state, E event) const noexcept {
+    const Cell cell = cells[cellIndex(state, event)];
+    return {static_cast<S>(cell.next), cell.guard, cell.action};
+  }
+
+  friend constexpr bool operator==(const EdgeTransitionTable &,
+                                   const EdgeTransitionTable &) = default;
+
+  static constexpr std::size_t cellIndex(S state, E event) noexcept {
+    return (static_cast<std::size_t>(state) * EventSize) +
+           static_cast<std::size_t>(event);
+  }
+
+ private:
+  static constexpr Cell SentinelCell{
+      static_cast<enum_utils::enum_index_t<S>>(StateSize), NoEdgeHook,
+      NoEdgeHook};
+
+  static constexpr std::array<Cell, CellCount> emptyCells() noexcept {
+    std::array<Cell, CellCount> empty{};
+    empty.fill(SentinelCell);
+    return empty;
+  }
+};
+
+// Table backends that store per-edge hook ids.
+template <typename T>
+concept EdgeTableBackend =
+    TransitionTableBackend<T> &&
+    requires(const T &table, typename T::State state, typename T::Event event) {
+      {
+        table.edge(state, event)
+      } -> std::same_as<TransitionEdge<typename T::State>>;
+    };
+
+} // namespace state_machine
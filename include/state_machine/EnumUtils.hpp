@@ -11,6 +11,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <type_traits>
 
 namespace enum_utils {
@@ -25,6 +26,15 @@ inline constexpr std::size_t enum_size_v = static_cast<std::size_t>(
 template <typename E>
 inline constexpr E enum_max_v = static_cast<E>(enum_size_v<E> - 1);
 
+// Narrowest unsigned integer able to hold every index 0..enum_size_v<E>,
+// i.e. all valid enumerators plus the sentinel.
+template <typename E>
+using enum_index_t = std::conditional_t<
+    enum_size_v<E> <= UINT8_MAX, std::uint8_t,
+    std::conditional_t<enum_size_v<E> <= UINT16_MAX, std::uint16_t,
+                       std::conditional_t<enum_size_v<E> <= UINT32_MAX,
+                                          std::uint32_t, std::uint64_t>>>;
+
 // Convenience functions if you prefer function templates over _v variables.
 template <typename E> constexpr std::size_t enum_size() {
   static_assert(std::is_enum_v<E>, "E must be an enum type");
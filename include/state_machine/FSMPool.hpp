@@ -0,0 +1,177 @@
+#pragma once
+
+#include "EnumUtils.hpp"
+#include "SimdKernels.hpp"
+#include "TransitionTable.hpp"
+#include "Types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace state_machine {
+
+// Many identical guard- and callback-free machines stored as one contiguous
+// array of states over a single shared table.
+//
+// Events without a transition leave the machine in its current state: the
+// pool keeps a resolved copy of the table where every empty cell points back
+// at its own row, so a step is one unconditional load per machine. On x86-64
+// the bulk step runs an AVX2/AVX-512 kernel picked at runtime: a byte
+// shuffle for one-byte enums whose table has at most 16 cells, otherwise a
+// gather for 1/2/4-byte enums, with a scalar loop for the tail.
+template <StateID S, EventID E> class FSMPool {
+ public:
+  FSMPool(const TransitionTable<S, E> &table, std::size_t count, S initial)
+      : table_(table), resolved_(resolve(table)),
+        shuffleCells_(resolveShuffle(table)), states_(count, initial) {}
+
+  std::size_t size() const noexcept { return states_.size(); }
+
+  void resize(std::size_t count, S initial) { states_.resize(count, initial); }
+
+  // Replaces every machine's state, e.g. from loadStates() (Snapshot.hpp).
+  void assign(std::span<const S> states) {
+    states_.assign(states.begin(), states.end());
+  }
+
+  // Appends a machine and returns its index.
+  std::size_t add(S initial) {
+    states_.push_back(initial);
+    return states_.size() - 1;
+  }
+
+  S getState(std::size_t index) const { return states_[index]; }
+
+  void setState(std::size_t index, S state) { states_[index] = state; }
+
+  std::span<const S> states() const noexcept { return states_; }
+
+  // Applies events[i] to machine first + i. Events past the end of the pool
+  // are ignored.
+  void step(std::span<const E> events, std::size_t first = 0) noexcept {
+    if (first >= states_.size()) {
+      return;
+    }
+    const auto count = std::min(events.size(), states_.size() - first);
+    S *states = states_.data() + first;
+    const S *cells = resolved_.data();
+    for (std::size_t i = stepVectorized(states, events.data(), count);
+         i < count; ++i) {
+      states[i] = cells[TransitionTable<S, E>::cellIndex(states[i], events[i])];
+    }
+  }
+
+  // Applies the same event to every machine.
+  void broadcast(E event) noexcept {
+    for (auto &state : states_) {
+      state = resolved_[TransitionTable<S, E>::cellIndex(state, event)];
+    }
+  }
+
+  const TransitionTable<S, E> &table() const noexcept { return table_; }
+
+  SimdLevel simdLevel() const noexcept { return simdLevel_; }
+
+  // Caps the kernel used by step(); levels above what the CPU supports fall
+  // back to the best supported one.
+  void setSimdLevel(SimdLevel level) noexcept {
+    simdLevel_ = std::min(level, detectSimdLevel());
+  }
+
+ private:
+  static constexpr auto StateSize = enum_utils::enum_size_v<S>;
+  static constexpr auto EventSize = enum_utils::enum_size_v<E>;
+
+  static constexpr auto CellCount = StateSize * EventSize;
+
+  static constexpr bool UseShuffle =
+      sizeof(S) == 1 && sizeof(E) == 1 &&
+      detail::ShuffleEligible<StateSize, EventSize>;
+  static constexpr bool UseGather = !UseShuffle &&
+                                    detail::GatherableWidth<S> &&
+                                    detail::GatherableWidth<E>;
+  static constexpr auto ShuffleShift = static_cast<int>(
+      std::countr_zero(detail::ShuffleStride<StateSize, EventSize>));
+
+  // Gather kernels load 32 bits at every cell, so pad past the last one.
+  using ResolvedCells = std::array<S, CellCount + (4 / sizeof(S))>;
+  using ShuffleCells = std::array<std::uint8_t, UseShuffle ? 16 : 0>;
+
+  static constexpr ResolvedCells
+  resolve(const TransitionTable<S, E> &table) noexcept {
+    ResolvedCells cells{};
+    for (const auto state : enum_utils::enum_values<S>()) {
+      for (const auto event : enum_utils::enum_values<E>()) {
+        const auto next = table.lookup(state, event);
+        cells[TransitionTable<S, E>::cellIndex(state, event)] =
+            next == S::MAX_VALUE ? state : next;
+      }
+    }
+    return cells;
+  }
+
+  static constexpr ShuffleCells
+  resolveShuffle(const TransitionTable<S, E> &table) noexcept {
+    ShuffleCells cells{};
+    if constexpr (UseShuffle) {
+      for (const auto state : enum_utils::enum_values<S>()) {
+        for (const auto event : enum_utils::enum_values<E>()) {
+          const auto next = table.lookup(state, event);
+          cells[(static_cast<std::size_t>(state) << ShuffleShift) |
+                static_cast<std::size_t>(event)] =
+              static_cast<std::uint8_t>(next == S::MAX_VALUE ? state : next);
+        }
+      }
+    }
+    return cells;
+  }
+
+  // Returns how many leading machines were stepped; the rest is left to the
+  // scalar loop.
+  std::size_t stepVectorized([[maybe_unused]] S *states,
+                             [[maybe_unused]] const E *events,
+                             [[maybe_unused]] std::size_t count) const noexcept {
+#if STATE_MACHINE_X86_KERNELS
+    if constexpr (UseShuffle) {
+      auto *s = reinterpret_cast<std::uint8_t *>(states);
+      const auto *e = reinterpret_cast<const std::uint8_t *>(events);
+      switch (simdLevel_) {
+      case SimdLevel::Avx512:
+        return detail::shuffleStepAvx512<ShuffleShift>(s, e, count,
+                                                       shuffleCells_.data());
+      case SimdLevel::Avx2:
+        return detail::shuffleStepAvx2<ShuffleShift>(s, e, count,
+                                                     shuffleCells_.data());
+      case SimdLevel::Scalar:
+        break;
+      }
+    } else if constexpr (UseGather) {
+      constexpr auto stride = static_cast<int>(EventSize);
+      switch (simdLevel_) {
+      case SimdLevel::Avx512:
+        return detail::gatherStepAvx512<sizeof(S), sizeof(E), stride>(
+            states, events, count, resolved_.data());
+      case SimdLevel::Avx2:
+        return detail::gatherStepAvx2<sizeof(S), sizeof(E), stride>(
+            states, events, count, resolved_.data());
+      case SimdLevel::Scalar:
+        break;
+      }
+    }
+#endif
+    return 0;
+  }
+
+  TransitionTable<S, E> table_;
+  ResolvedCells resolved_;
+  [[no_unique_address]] ShuffleCells shuffleCells_;
+  std::vector<S> states_;
+  SimdLevel simdLevel_ = detectSimdLevel();
+};
+
+} // namespace state_machine
@@ -0,0 +1,305 @@
+#pragma once
+
+#include "MpscQueue.hpp"
+#include "Types.hpp"
+#include "WorkStealingDeque.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace state_machine {
+
+using MachineId = std::size_t;
+
+namespace detail {
+
+struct WorkerContext {
+  const void *scheduler = nullptr;
+  std::size_t index = 0;
+};
+
+inline thread_local WorkerContext currentWorkerContext{};
+
+} // namespace detail
+
+// Drives many single-threaded machines (FSM, FSMInstance, ...) from a pool
+// of worker threads. Every machine has its own bounded lock-free inbox; a
+// machine with pending events is queued on one worker at a time, so
+// Machine needs no synchronisation and its callbacks run on that worker.
+//
+// Runnable machines sit in per-worker Chase-Lev deques. Idle workers steal
+// from the others; posts from outside the pool go to the machine's home
+// worker through a lock-free injection queue. No global lock is involved.
+//
+// Add machines before start(). Each inbox holds InboxCapacity events, which
+// dominates per-machine memory when running millions of machines.
+template <typename Machine, std::size_t InboxCapacity = 16>
+class FSMScheduler {
+ public:
+  using State = typename Machine::State;
+  using Event = typename Machine::Event;
+  using Result = std::expected<State, ProcessEventErr>;
+  using CompletionHandler = std::function<void(MachineId, Event, Result)>;
+
+  explicit FSMScheduler(std::size_t workerCount = 0,
+                        CompletionHandler onComplete = {})
+      : onComplete_(std::move(onComplete)) {
+    if (workerCount == 0) {
+      workerCount = std::max(1U, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(workerCount);
+    for (std::size_t i = 0; i < workerCount; ++i) {
+      workers_.push_back(std::make_unique<Worker>());
+    }
+  }
+
+  FSMScheduler(const FSMScheduler &) = delete;
+  FSMScheduler &operator=(const FSMScheduler &) = delete;
+
+  ~FSMScheduler() { stop(); }
+
+  // Not thread safe; call before start().
+  MachineId addMachine(Machine machine) {
+    const MachineId id = slots_.size();
+    slots_.emplace_back(std::move(machine), id, id % workers_.size());
+    return id;
+  }
+
+  // Only while stopped, or from the machine's own callbacks.
+  Machine &machine(MachineId id) noexcept { return slots_[id].machine; }
+
+  std::size_t size() const noexcept { return slots_.size(); }
+  std::size_t workerCount() const noexcept { return workers_.size(); }
+
+  // Any thread, including workers. Returns false if the machine's inbox is
+  // full or the scheduler is not running. Once stop() has begun, only posts
+  // from this scheduler's workers (e.g. from callbacks) are accepted; they
+  // are processed before stop() returns.
+  bool post(MachineId id, Event event) {
+    // Counted before running_ is checked, pairing with stop(), which
+    // clears running_ before waiting for zero: either this post sees the
+    // scheduler stopping and backs out, or stop() waits for the event. A
+    // worker's post happens while its own event is still counted, so it
+    // is always waited for.
+    outstanding_.fetch_add(1);
+    if (!running_.load() && !currentWorker()) {
+      outstanding_.fetch_sub(1, std::memory_order_release);
+      return false;
+    }
+    auto &slot = slots_[id];
+    if (!slot.inbox.tryPush(event)) {
+      outstanding_.fetch_sub(1, std::memory_order_release);
+      return false;
+    }
+    // The increment that finds zero owns scheduling the machine.
+    if (slot.pending.fetch_add(1, std::memory_order_acq_rel) == 0) {
+      schedule(slot);
+    }
+    return true;
+  }
+
+  void start() {
+    if (running_.exchange(true)) {
+      return;
+    }
+    stopping_.store(false);
+    threads_.reserve(workers_.size());
+    for (std::size_t i = 0; i < workers_.size(); ++i) {
+      threads_.emplace_back([this, i] { run(i); });
+    }
+  }
+
+  // Stops accepting posts from outside the pool, waits until every accepted
+  // event (including those posted by workers meanwhile) has been processed,
+  // then joins workers. Must not be called from a worker.
+  void stop() {
+    if (!running_.exchange(false)) {
+      return;
+    }
+    while (outstanding_.load() != 0) {
+      std::this_thread::yield();
+    }
+    stopping_.store(true);
+    for (auto &worker : workers_) {
+      wake(*worker);
+    }
+    threads_.clear();
+  }
+
+  // Index of the calling worker thread, if it belongs to this scheduler.
+  std::optional<std::size_t> currentWorker() const noexcept {
+    const auto &ctx = detail::currentWorkerContext;
+    if (ctx.scheduler != this) {
+      return std::nullopt;
+    }
+    return ctx.index;
+  }
+
+ private:
+  static constexpr std::size_t BatchSize = 32;
+  static constexpr std::size_t DequeCapacity = 4096;
+  static constexpr std::size_t InjectionCapacity = 4096;
+
+  struct Slot {
+    Slot(Machine m, MachineId slotId, std::size_t homeWorker)
+        : machine(std::move(m)), id(slotId), home(homeWorker) {}
+
+    Machine machine;
+    MachineId id;
+    std::size_t home;
+    // Events pushed but not yet processed; non-zero means queued or running.
+    std::atomic<std::uint32_t> pending{0};
+    MpscQueue<Event, InboxCapacity> inbox;
+  };
+
+  struct Worker {
+    WorkStealingDeque<Slot, DequeCapacity> local;
+    // Owner-only spill area for when `local` is full, so a worker never
+    // waits on a queue that only it can drain.
+    std::vector<Slot *> overflow;
+    MpscQueue<Slot *, InjectionCapacity> injected;
+    std::atomic<bool> sleeping{false};
+    std::atomic<std::uint32_t> signal{0};
+  };
+
+  void schedule(Slot &slot) {
+    if (const auto self = currentWorker()) {
+      auto &worker = *workers_[*self];
+      if (worker.local.push(&slot)) {
+        wakeIdleThief(*self);
+      } else {
+        worker.overflow.push_back(&slot);
+      }
+      return;
+    }
+    // Outside the pool: hand it to the home worker, falling back to the
+    // others if its injection queue is full.
+    for (std::size_t attempt = 0;; ++attempt) {
+      auto &worker = *workers_[(slot.home + attempt) % workers_.size()];
+      if (worker.injected.tryPush(&slot)) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (worker.sleeping.load(std::memory_order_relaxed)) {
+          wake(worker);
+        }
+        return;
+      }
+      if (attempt % workers_.size() == workers_.size() - 1) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  static void wake(Worker &worker) noexcept {
+    worker.signal.fetch_add(1, std::memory_order_release);
+    worker.signal.notify_one();
+  }
+
+  void wakeIdleThief(std::size_t self) noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (std::size_t i = 1; i < workers_.size(); ++i) {
+      auto &other = *workers_[(self + i) % workers_.size()];
+      if (other.sleeping.load(std::memory_order_relaxed)) {
+        wake(other);
+        return;
+      }
+    }
+  }
+
+  Slot *findWork(std::size_t index) noexcept {
+    auto &self = *workers_[index];
+    while (!self.overflow.empty() && self.local.push(self.overflow.back())) {
+      self.overflow.pop_back();
+    }
+    if (Slot *slot = self.local.pop()) {
+      return slot;
+    }
+    if (auto slot = self.injected.tryPop()) {
+      return *slot;
+    }
+    for (std::size_t i = 1; i < workers_.size(); ++i) {
+      if (Slot *slot = workers_[(index + i) % workers_.size()]->local.steal()) {
+        return slot;
+      }
+    }
+    return nullptr;
+  }
+
+  bool hasVisibleWork(std::size_t index) const noexcept {
+    if (!workers_[index]->injected.empty() ||
+        !workers_[index]->overflow.empty()) {
+      return true;
+    }
+    for (const auto &worker : workers_) {
+      if (!worker->local.empty()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void runMachine(Slot &slot) {
+    const auto available = slot.pending.load(std::memory_order_acquire);
+    std::uint32_t processed = 0;
+    while (processed < available && processed < BatchSize) {
+      const auto event = slot.inbox.tryPop();
+      if (!event) {
+        break;
+      }
+      auto result = slot.machine.processEvent(*event);
+      if (onComplete_) {
+        onComplete_(slot.id, *event, std::move(result));
+      }
+      ++processed;
+    }
+    outstanding_.fetch_sub(processed, std::memory_order_release);
+    // Still pending events: put the machine back so others can steal it.
+    if (slot.pending.fetch_sub(processed, std::memory_order_acq_rel) !=
+        processed) {
+      schedule(slot);
+    }
+  }
+
+  void run(std::size_t index) {
+    detail::currentWorkerContext = {this, index};
+    auto &self = *workers_[index];
+    for (;;) {
+      if (Slot *slot = findWork(index)) {
+        runMachine(*slot);
+        continue;
+      }
+      if (stopping_.load(std::memory_order_acquire)) {
+        break;
+      }
+      const auto seen = self.signal.load(std::memory_order_acquire);
+      self.sleeping.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!hasVisibleWork(index) &&
+          !stopping_.load(std::memory_order_acquire)) {
+        self.signal.wait(seen, std::memory_order_acquire);
+      }
+      self.sleeping.store(false, std::memory_order_relaxed);
+    }
+    detail::currentWorkerContext = {};
+  }
+
+  CompletionHandler onComplete_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  // std::deque keeps slot addresses stable as machines are added.
+  std::deque<Slot> slots_;
+  std::atomic<bool> running_{false};
+  std::atomic<bool> stopping_{false};
+  std::atomic<std::size_t> outstanding_{0};
+  std::vector<std::jthread> threads_;
+};
+
+} // namespace state_machine
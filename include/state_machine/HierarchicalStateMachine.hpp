@@ -0,0 +1,244 @@
+#pragma once
+
+#include "EnumUtils.hpp"
+#include "MachineDefinition.hpp"
+#include "TransitionTable.hpp"
+#include "Types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace state_machine {
+
+// FSM with nested states. setParent() builds a state tree alongside
+// enableTransition(); a state without its own transition for an event
+// inherits its nearest ancestor's, and a state without its own guard uses its
+// nearest ancestor's.
+//
+// Transitions are external: leaving `from` for `to` exits every state from
+// `from` up to (not including) their least common ancestor, then enters
+// every state from below that ancestor down to `to`. A self-transition (or
+// one to an ancestor) exits and re-enters the target. Exit callbacks get
+// (Exit, exitedState, to, event), Enter callbacks (Enter, from, enteredState,
+// event); the current state changes between the two sequences.
+//
+// freeze() flattens the tree into one cell per (state, event) holding the
+// target and a slice of a shared path array with the precomputed exit/enter
+// sequence, so processEvent() never walks the hierarchy. Any configuration
+// change unfreezes the machine; the next processEvent() refreezes it.
+template <StateID S, EventID E> class HierarchicalFSM {
+ public:
+  using State = S;
+  using Event = E;
+
+  explicit HierarchicalFSM(S initial) : currentState_(initial) {
+    parents_.fill(S::MAX_VALUE);
+  }
+
+  void init() {
+    authored_.clear();
+    parents_.fill(S::MAX_VALUE);
+    for (auto &guard : guards_) {
+      guard = {};
+    }
+    callbacks_.init();
+    frozen_ = false;
+  }
+
+  // Makes `parent` the parent of `child` (S::MAX_VALUE makes it a root).
+  // Returns false, changing nothing, if that would create a cycle.
+  bool setParent(S child, S parent) {
+    for (S s = parent; s != S::MAX_VALUE; s = parents_[index(s)]) {
+      if (s == child) {
+        return false;
+      }
+    }
+    parents_[index(child)] = parent;
+    frozen_ = false;
+    return true;
+  }
+
+  // S::MAX_VALUE for a root state.
+  S parent(S state) const noexcept { return parents_[index(state)]; }
+
+  void enableTransition(S from, S to, E onEvent) {
+    authored_.enable(from, to, onEvent);
+    frozen_ = false;
+  }
+
+  void disableTransition(S from, S /*to*/, E onEvent) {
+    authored_.disable(from, onEvent);
+    frozen_ = false;
+  }
+
+  void attachTransitionGuard(S state, TransitionGuard<S, E> guard) {
+    guards_[index(state)] = std::move(guard);
+    frozen_ = false;
+  }
+
+  void attachOnEnterStateCallback(S state,
+                                  TransitionCallbackFn<S, E> callback) {
+    callbacks_.attachOnEnterStateCallback(state, std::move(callback));
+  }
+
+  void attachOnExitStateCallback(S state, TransitionCallbackFn<S, E> callback) {
+    callbacks_.attachOnExitStateCallback(state, std::move(callback));
+  }
+
+  // Flattens inherited transitions and guards and precomputes every
+  // transition's exit/enter path. Cost is O(states * events * depth).
+  void freeze() {
+    cells_.assign(StateSize * EventSize, Cell{});
+    paths_.clear();
+    // Transitions sharing (from, to) share one path slice.
+    std::vector<Cell> pathByPair(StateSize * StateSize, Cell{});
+    std::vector<bool> havePath(StateSize * StateSize, false);
+
+    for (std::size_t s = 0; s < StateSize; ++s) {
+      const auto from = static_cast<S>(s);
+      guardOf_[s] = S::MAX_VALUE;
+      for (S a = from; a != S::MAX_VALUE; a = parents_[index(a)]) {
+        if (guards_[index(a)]) {
+          guardOf_[s] = a;
+          break;
+        }
+      }
+
+      for (std::size_t e = 0; e < EventSize; ++e) {
+        const auto event = static_cast<E>(e);
+        S to = S::MAX_VALUE;
+        for (S a = from; a != S::MAX_VALUE && to == S::MAX_VALUE;
+             a = parents_[index(a)]) {
+          to = authored_.lookup(a, event);
+        }
+        if (to == S::MAX_VALUE) {
+          continue;
+        }
+        const auto pair = (s * StateSize) + index(to);
+        if (!havePath[pair]) {
+          havePath[pair] = true;
+          pathByPair[pair] = appendPath(from, to);
+        }
+        Cell cell = pathByPair[pair];
+        cell.next = to;
+        cells_[(s * EventSize) + e] = cell;
+      }
+    }
+    frozen_ = true;
+  }
+
+  std::expected<S, ProcessEventErr> processEvent(E event) {
+    if (!frozen_) [[unlikely]] {
+      freeze();
+    }
+    const S from = currentState_;
+    const Cell &cell =
+        cells_[(index(from) * EventSize) + static_cast<std::size_t>(event)];
+    const S to = cell.next;
+    if (to == S::MAX_VALUE) {
+      return std::unexpected(ProcessEventErr::NoNextStateFound);
+    }
+
+    const S guardState = guardOf_[index(from)];
+    if (guardState != S::MAX_VALUE &&
+        !std::invoke(guards_[index(guardState)], from, to, event)) {
+      return std::unexpected(ProcessEventErr::TransitionForbidden);
+    }
+
+    if (!callbacks_.hasHooks()) {
+      currentState_ = to;
+      return to;
+    }
+    const S *path = paths_.data() + cell.pathOffset;
+    for (std::uint16_t i = 0; i < cell.exitCount; ++i) {
+      callbacks_.notifyExit(path[i], to, event);
+    }
+    currentState_ = to;
+    path += cell.exitCount;
+    for (std::uint16_t i = 0; i < cell.enterCount; ++i) {
+      callbacks_.notifyEnter(from, path[i], event);
+    }
+    return to;
+  }
+
+  S getCurrentState() const noexcept { return currentState_; }
+
+  // True if the current state is `state` or one of its descendants.
+  bool isIn(S state) const noexcept {
+    for (S s = currentState_; s != S::MAX_VALUE; s = parents_[index(s)]) {
+      if (s == state) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool frozen() const noexcept { return frozen_; }
+
+ private:
+  static constexpr auto StateSize = enum_utils::enum_size_v<S>;
+  static constexpr auto EventSize = enum_utils::enum_size_v<E>;
+
+  struct Cell {
+    S next = S::MAX_VALUE;
+    std::uint16_t exitCount = 0;
+    std::uint16_t enterCount = 0;
+    std::uint32_t pathOffset = 0;
+  };
+
+  static constexpr std::size_t index(S state) noexcept {
+    return static_cast<std::size_t>(state);
+  }
+
+  // Appends the exit sequence (innermost first) and enter sequence
+  // (outermost first) of from -> to to paths_.
+  Cell appendPath(S from, S to) {
+    std::array<bool, StateSize> onTargetBranch{};
+    for (S s = to; s != S::MAX_VALUE; s = parents_[index(s)]) {
+      onTargetBranch[index(s)] = true;
+    }
+    S ancestor = from;
+    while (ancestor != S::MAX_VALUE && !onTargetBranch[index(ancestor)]) {
+      ancestor = parents_[index(ancestor)];
+    }
+    if (ancestor == from || ancestor == to) {
+      ancestor = parents_[index(ancestor)];
+    }
+
+    Cell cell{};
+    cell.pathOffset = static_cast<std::uint32_t>(paths_.size());
+    for (S s = from; s != ancestor; s = parents_[index(s)]) {
+      paths_.push_back(s);
+      ++cell.exitCount;
+    }
+    const auto enterBegin = paths_.size();
+    for (S s = to; s != ancestor; s = parents_[index(s)]) {
+      paths_.push_back(s);
+      ++cell.enterCount;
+    }
+    std::reverse(paths_.begin() + static_cast<std::ptrdiff_t>(enterBegin),
+                 paths_.end());
+    return cell;
+  }
+
+  S currentState_;
+  bool frozen_ = false;
+  TransitionTable<S, E> authored_{};
+  std::array<S, StateSize> parents_{};
+  std::array<TransitionGuard<S, E>, StateSize> guards_{};
+  // Only its callback storage is used; transitions live in authored_/cells_.
+  MachineDefinition<S, E> callbacks_{};
+
+  // Built by freeze().
+  std::vector<Cell> cells_{};
+  std::vector<S> paths_{};
+  std::array<S, StateSize> guardOf_{};
+};
+
+} // namespace state_machine
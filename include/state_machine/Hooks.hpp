@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Types.hpp"
+
+#include <concepts>
+#include <expected>
+
+namespace state_machine {
+
+// Statically dispatched guards and callbacks.
+//
+// A hooks policy is any class with some of these members; missing ones cost
+// nothing and calls are visible to the optimiser:
+//
+//   struct Hooks {
+//     bool guard(State from, State to, Event event);
+//     void onExit(State from, State to, Event event);
+//     void onEnter(State from, State to, Event event);
+//   };
+struct NoHooks {};
+
+template <typename H, typename S, typename E>
+concept HasGuardHook = requires(H &hooks, S state, E event) {
+  { hooks.guard(state, state, event) } -> std::convertible_to<bool>;
+};
+
+template <typename H, typename S, typename E>
+concept HasExitHook = requires(H &hooks, S state, E event) {
+  hooks.onExit(state, state, event);
+};
+
+template <typename H, typename S, typename E>
+concept HasEnterHook = requires(H &hooks, S state, E event) {
+  hooks.onEnter(state, state, event);
+};
+
+namespace detail {
+
+// Same sequence as MachineDefinition::processEvent(): lookup, guard, Exit,
+// state update, Enter.
+template <typename Table, typename Hooks, typename S = typename Table::State,
+          typename E = typename Table::Event>
+constexpr std::expected<S, ProcessEventErr>
+processWithHooks(const Table &table, S &currentState, E event, Hooks &hooks) {
+  const auto nextState = table.lookup(currentState, event);
+  if (nextState == S::MAX_VALUE) {
+    return std::unexpected(ProcessEventErr::NoNextStateFound);
+  }
+
+  if constexpr (HasGuardHook<Hooks, S, E>) {
+    if (!hooks.guard(currentState, nextState, event)) {
+      return std::unexpected(ProcessEventErr::TransitionForbidden);
+    }
+  }
+
+  if constexpr (HasExitHook<Hooks, S, E>) {
+    hooks.onExit(currentState, nextState, event);
+  }
+
+  const S prevState = currentState;
+  currentState = nextState;
+
+  if constexpr (HasEnterHook<Hooks, S, E>) {
+    hooks.onEnter(prevState, nextState, event);
+  }
+
+  return nextState;
+}
+
+} // namespace detail
+} // namespace state_machine
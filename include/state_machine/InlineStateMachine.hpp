@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Hooks.hpp"
+#include "TransitionTable.hpp"
+#include "Types.hpp"
+
+#include <expected>
+#include <utility>
+
+namespace state_machine {
+
+// FSM with a runtime-configurable table whose guard and callbacks come from
+// a hooks policy (see Hooks.hpp) instead of std::function. Nothing is type
+// erased or heap allocated, and hook calls can be inlined into
+// processEvent().
+template <StateID S, EventID E, typename Hooks = NoHooks> class InlineFSM {
+ public:
+  InlineFSM(S initial, Hooks hooks = {})
+      : currentState_(initial), hooks_(std::move(hooks)) {}
+
+  InlineFSM(S initial, const TransitionTable<S, E> &table, Hooks hooks = {})
+      : currentState_(initial), table_(table), hooks_(std::move(hooks)) {}
+
+  void init() { table_.clear(); }
+
+  void init(const TransitionTable<S, E> &table) { table_ = table; }
+
+  void enableTransition(S from, S to, E onEvent) {
+    table_.enable(from, to, onEvent);
+  }
+
+  void disableTransition(S from, S /*to*/, E onEvent) {
+    table_.disable(from, onEvent);
+  }
+
+  std::expected<S, ProcessEventErr> processEvent(E event) {
+    return detail::processWithHooks(table_, currentState_, event, hooks_);
+  }
+
+  S getCurrentState() const { return currentState_; }
+
+  Hooks &hooks() noexcept { return hooks_; }
+  const Hooks &hooks() const noexcept { return hooks_; }
+
+ private:
+  S currentState_{};
+  TransitionTable<S, E> table_{};
+  [[no_unique_address]] Hooks hooks_;
+};
+
+} // namespace state_machine
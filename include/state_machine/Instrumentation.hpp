@@ -0,0 +1,175 @@
+#pragma once
+
+#include "EnumUtils.hpp"
+#include "Types.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace state_machine {
+
+// Optional per-transition instrumentation for FSM.
+//
+// An instrumentation policy is any class with some of these members; FSM
+// calls the present ones and compiles the rest away, so the default
+// NoInstrumentation costs nothing:
+//
+//   struct Instrumentation {
+//     void onTransition(State from, State to, Event event);
+//     void onRejected(State from, Event event, ProcessEventErr err);
+//     // Time spent in the transition's Exit + Enter callbacks.
+//     void onCallbacks(State from, State to, Event event,
+//                      std::chrono::nanoseconds elapsed);
+//   };
+struct NoInstrumentation {};
+
+template <typename I, typename S, typename E>
+concept CountsTransitions = requires(I &instr, S state, E event) {
+  instr.onTransition(state, state, event);
+};
+
+template <typename I, typename S, typename E>
+concept CountsRejections =
+    requires(I &instr, S state, E event, ProcessEventErr err) {
+      instr.onRejected(state, event, err);
+    };
+
+template <typename I, typename S, typename E>
+concept TimesCallbacks = requires(I &instr, S state, E event,
+                                  std::chrono::nanoseconds elapsed) {
+  instr.onCallbacks(state, state, event, elapsed);
+};
+
+template <typename I, typename S, typename E>
+inline constexpr bool is_instrumented_v =
+    CountsTransitions<I, S, E> || CountsRejections<I, S, E> ||
+    TimesCallbacks<I, S, E>;
+
+// Counters shared by any number of machines, possibly on different threads.
+// Every update is a relaxed fetch_add on its own counter, so recording never
+// orders or serializes threads; readers see eventually consistent values.
+//
+// Layout: one hit counter per (state, event) cell, parallel to the
+// transition table; one rejection counter per (error, state, event); and a
+// log2 histogram of callback time in nanoseconds (bucket i counts
+// [2^i, 2^(i+1)) ns, bucket 0 also counts 0 ns).
+template <StateID S, EventID E> class TransitionStats {
+ public:
+  static constexpr std::size_t HistogramBuckets = 64;
+
+  TransitionStats() = default;
+  TransitionStats(const TransitionStats &) = delete;
+  TransitionStats &operator=(const TransitionStats &) = delete;
+
+  void recordHit(S from, E event) noexcept {
+    hits_[cellIndex(from, event)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void recordRejection(S from, E event, ProcessEventErr err) noexcept {
+    rejections_[(errorIndex(err) * CellCount) + cellIndex(from, event)]
+        .fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void recordCallbackTime(std::chrono::nanoseconds elapsed) noexcept {
+    const auto ns = static_cast<std::uint64_t>(
+        elapsed.count() > 0 ? elapsed.count() : 0);
+    const auto bucket = ns == 0 ? 0 : std::bit_width(ns) - 1;
+    histogram_[static_cast<std::size_t>(bucket)].fetch_add(
+        1, std::memory_order_relaxed);
+  }
+
+  std::uint64_t hits(S from, E event) const noexcept {
+    return hits_[cellIndex(from, event)].load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t rejections(S from, E event,
+                           ProcessEventErr err) const noexcept {
+    return rejections_[(errorIndex(err) * CellCount) + cellIndex(from, event)]
+        .load(std::memory_order_relaxed);
+  }
+
+  // Sum over every cell for one error kind.
+  std::uint64_t rejections(ProcessEventErr err) const noexcept {
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < CellCount; ++i) {
+      total += rejections_[(errorIndex(err) * CellCount) + i].load(
+          std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  std::array<std::uint64_t, HistogramBuckets> callbackHistogram() const {
+    std::array<std::uint64_t, HistogramBuckets> snapshot{};
+    for (std::size_t i = 0; i < HistogramBuckets; ++i) {
+      snapshot[i] = histogram_[i].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+  }
+
+  void reset() noexcept {
+    for (auto &c : hits_) {
+      c.store(0, std::memory_order_relaxed);
+    }
+    for (auto &c : rejections_) {
+      c.store(0, std::memory_order_relaxed);
+    }
+    for (auto &c : histogram_) {
+      c.store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  static constexpr auto StateSize = enum_utils::enum_size_v<S>;
+  static constexpr auto EventSize = enum_utils::enum_size_v<E>;
+  static constexpr auto CellCount = StateSize * EventSize;
+  static constexpr std::size_t ErrorKinds =
+      enum_utils::enum_size_v<ProcessEventErr>;
+
+  static constexpr std::size_t cellIndex(S from, E event) noexcept {
+    return (static_cast<std::size_t>(from) * EventSize) +
+           static_cast<std::size_t>(event);
+  }
+
+  static constexpr std::size_t errorIndex(ProcessEventErr err) noexcept {
+    return static_cast<std::size_t>(err);
+  }
+
+  std::array<std::atomic<std::uint64_t>, CellCount> hits_{};
+  std::array<std::atomic<std::uint64_t>, ErrorKinds * CellCount> rejections_{};
+  std::array<std::atomic<std::uint64_t>, HistogramBuckets> histogram_{};
+};
+
+// Instrumentation policy recording into a TransitionStats that outlives the
+// machine. Copies of the machine keep recording into the same stats. With
+// TimeCallbacks, each transition's callbacks are timed with steady_clock.
+template <StateID S, EventID E, bool TimeCallbacks = false>
+class CountingInstrumentation {
+ public:
+  explicit CountingInstrumentation(TransitionStats<S, E> &stats) noexcept
+      : stats_(&stats) {}
+
+  void onTransition(S from, S /*to*/, E event) noexcept {
+    stats_->recordHit(from, event);
+  }
+
+  void onRejected(S from, E event, ProcessEventErr err) noexcept {
+    stats_->recordRejection(from, event, err);
+  }
+
+  void onCallbacks(S, S, E, std::chrono::nanoseconds elapsed) noexcept
+    requires TimeCallbacks
+  {
+    stats_->recordCallbackTime(elapsed);
+  }
+
+  TransitionStats<S, E> &stats() const noexcept { return *stats_; }
+
+ private:
+  TransitionStats<S, E> *stats_;
+};
+
+} // namespace state_machine
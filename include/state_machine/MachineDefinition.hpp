@@ -0,0 +1,694 @@
+#pragma once
+
+#include "EdgeTransitionTable.hpp"
+#include "EnumUtils.hpp"
+#include "Minimize.hpp"
+#include "PmrFunction.hpp"
+#include "TransitionTable.hpp"
+#include "Types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <iterator>
+#include <memory_resource>
+#include <limits>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace state_machine {
+
+namespace detail {
+
+// Results of pure guards, two bits per (state, event) cell (known, allowed)
+// packed 32 cells to a word. Each word is a relaxed atomic, so machines on
+// different threads sharing one definition can fill the cache concurrently;
+// a cell's two bits are always written together. Storage is only allocated
+// once a pure guard is attached.
+class GuardCache {
+  struct Word {
+    Word() = default;
+    Word(const Word &other) noexcept
+        : bits(other.bits.load(std::memory_order_relaxed)) {}
+    Word &operator=(const Word &other) noexcept {
+      bits.store(other.bits.load(std::memory_order_relaxed),
+                 std::memory_order_relaxed);
+      return *this;
+    }
+
+    mutable std::atomic<std::uint64_t> bits{0};
+  };
+
+ public:
+  GuardCache() = default;
+
+  explicit GuardCache(std::pmr::memory_resource *resource)
+      : words_(ResourceAllocator<Word>(resource)) {}
+
+  void reserve(std::size_t cells) {
+    words_.resize((cells + CellsPerWord - 1) / CellsPerWord);
+  }
+
+  std::optional<bool> lookup(std::size_t cell) const noexcept {
+    const auto bits = words_[cell / CellsPerWord].bits.load(
+                          std::memory_order_relaxed) >>
+                      shift(cell);
+    if (!(bits & Known)) {
+      return std::nullopt;
+    }
+    return (bits & Allowed) != 0;
+  }
+
+  void store(std::size_t cell, bool allowed) const noexcept {
+    words_[cell / CellsPerWord].bits.fetch_or(
+        (Known | (allowed ? Allowed : 0)) << shift(cell),
+        std::memory_order_relaxed);
+  }
+
+  void clear() const noexcept {
+    for (const auto &word : words_) {
+      word.bits.store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  static constexpr std::size_t CellsPerWord = 32;
+  static constexpr std::uint64_t Known = 1;
+  static constexpr std::uint64_t Allowed = 2;
+
+  static constexpr unsigned shift(std::size_t cell) noexcept {
+    return static_cast<unsigned>(2 * (cell % CellsPerWord));
+  }
+
+  std::vector<Word, ResourceAllocator<Word>> words_{};
+};
+
+// Per-edge guards and actions of a definition over an EdgeTableBackend, in
+// id order (id i is element i - 1).
+template <typename GuardFn, typename ActionFn> struct EdgeHooks {
+  EdgeHooks() = default;
+  explicit EdgeHooks(std::pmr::memory_resource *resource)
+      : guards(ResourceAllocator<GuardFn>(resource)),
+        actions(ResourceAllocator<ActionFn>(resource)) {}
+
+  std::vector<GuardFn, ResourceAllocator<GuardFn>> guards{};
+  std::vector<ActionFn, ResourceAllocator<ActionFn>> actions{};
+};
+
+// Storage stand-in for tables without edge hooks.
+struct NoEdgeHooks {
+  NoEdgeHooks() = default;
+  explicit NoEdgeHooks(std::pmr::memory_resource *) noexcept {}
+};
+
+} // namespace detail
+
+// Transition table, guards and callbacks of a machine, without any
+// per-instance state. One definition can drive any number of FSMInstance
+// objects; it must outlive them and must not be reconfigured while they
+// process events.
+//
+// `Table` selects the transition table backend: the dense TransitionTable by
+// default, or e.g. SparseTransitionTable for large, mostly empty tables.
+//
+// Guards, callbacks and the callback buffer are allocated from the
+// memory_resource given at construction (the default resource otherwise),
+// e.g. a per-session std::pmr::monotonic_buffer_resource. Callables are
+// constructed there directly, captures included. Moves keep the resource;
+// copies use the default resource, since they may outlive an arena. The
+// dense table itself is stored inline.
+//
+// With an EdgeTransitionTable, each cell can also name a guard and an
+// action registered with addEdgeGuard() / addEdgeAction(). An edge guard
+// runs after the source state's guard; an edge action runs after the Exit
+// callbacks and before the state changes and the Enter callbacks run.
+//
+// Guards attached as GuardPurity::Pure are called once per (state, event)
+// cell; later events reuse the cached result until invalidateGuards() or
+// any reconfiguration.
+template <StateID S, EventID E, typename Table = TransitionTable<S, E>>
+  requires TransitionTableBackend<Table> &&
+           std::same_as<typename Table::State, S> &&
+           std::same_as<typename Table::Event, E>
+class MachineDefinition {
+  using CallbackFn = PmrFunction<void(TransitionType, S, S, E)>;
+  using GuardFn = PmrFunction<bool(S, S, E)>;
+  using ActionFn = PmrFunction<void(S, S, E)>;
+  using CallbackAllocator = detail::ResourceAllocator<CallbackFn>;
+  static constexpr bool HasEdges = EdgeTableBackend<Table>;
+
+ public:
+  MachineDefinition() = default;
+
+  explicit MachineDefinition(std::pmr::memory_resource *resource)
+      : transitionCallbacks_(CallbackAllocator(resource)),
+        guardCache_(resource), edgeHooks_(resource) {
+    adoptGuardResource();
+  }
+
+  explicit MachineDefinition(
+      const Table &table,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : table_(table), transitionCallbacks_(CallbackAllocator(resource)),
+        guardCache_(resource), edgeHooks_(resource) {
+    adoptGuardResource();
+  }
+
+  void init() {
+    table_.clear();
+    resetGuards();
+    transitionCallbacks_.clear();
+    callbackOffsets_.fill(0);
+    hookFlags_.fill(0);
+    anyHookFlags_ = 0;
+    guardCache_.clear();
+    if constexpr (HasEdges) {
+      edgeHooks_.guards.clear();
+      edgeHooks_.actions.clear();
+    }
+  }
+
+  // Resets guards and callbacks like init(), then loads a prebuilt table.
+  void init(const Table &table) {
+    init();
+    table_ = table;
+  }
+
+  // Any copyable callable; it is stored in the definition's resource
+  // without going through std::function.
+  template <TransitionCallable<S, E> F>
+  void attachOnEnterStateCallback(S state, F &&callback) {
+    attachTransitionCallback(TransitionType::Enter, state,
+                             CallbackFn(std::forward<F>(callback), resource()));
+  }
+
+  void attachOnEnterStateCallback(S state,
+                                  TransitionCallbackFn<S, E> callback) {
+    attachOnEnterStateCallback<TransitionCallbackFn<S, E>>(state,
+                                                           std::move(callback));
+  }
+
+  template <TransitionCallable<S, E> F>
+  void attachOnExitStateCallback(S state, F &&callback) {
+    attachTransitionCallback(TransitionType::Exit, state,
+                             CallbackFn(std::forward<F>(callback), resource()));
+  }
+
+  void attachOnExitStateCallback(S state, TransitionCallbackFn<S, E> callback) {
+    attachOnExitStateCallback<TransitionCallbackFn<S, E>>(state,
+                                                          std::move(callback));
+  }
+
+  void enableTransition(S from, S to, E onEvent) {
+    table_.enable(from, to, onEvent);
+    guardCache_.clear();
+  }
+
+  void disableTransition(S from, S /*to*/, E onEvent) {
+    table_.disable(from, onEvent);
+    guardCache_.clear();
+  }
+
+  void enableTransition(S from, S to, E onEvent, EdgeHookId guard,
+                        EdgeHookId action = NoEdgeHook)
+    requires HasEdges
+  {
+    table_.enable(from, to, onEvent, guard, action);
+    guardCache_.clear();
+  }
+
+  // Registers a guard for the edges naming the returned id. Returns
+  // NoEdgeHook once every 16-bit id is taken.
+  template <TransitionGuardCallable<S, E> F>
+    requires HasEdges
+  EdgeHookId addEdgeGuard(F &&guard) {
+    return addEdgeHook(edgeHooks_.guards,
+                       GuardFn(std::forward<F>(guard), resource()));
+  }
+
+  EdgeHookId addEdgeGuard(TransitionGuard<S, E> guard)
+    requires HasEdges
+  {
+    return addEdgeGuard<TransitionGuard<S, E>>(std::move(guard));
+  }
+
+  template <TransitionActionCallable<S, E> F>
+    requires HasEdges
+  EdgeHookId addEdgeAction(F &&action) {
+    return addEdgeHook(edgeHooks_.actions,
+                       ActionFn(std::forward<F>(action), resource()));
+  }
+
+  EdgeHookId addEdgeAction(TransitionAction<S, E> action)
+    requires HasEdges
+  {
+    return addEdgeAction<TransitionAction<S, E>>(std::move(action));
+  }
+
+  template <TransitionGuardCallable<S, E> F>
+  void attachTransitionGuard(S state, F &&guard,
+                             GuardPurity purity = GuardPurity::Impure) {
+    GuardFn stored(std::forward<F>(guard), resource());
+    const bool present = static_cast<bool>(stored);
+    transitionGuards_[stateIndex(state)] = std::move(stored);
+    setHookFlag(state, HasGuard, present);
+    setHookFlag(state, HasPureGuard, present && purity == GuardPurity::Pure);
+    if (present && purity == GuardPurity::Pure) {
+      guardCache_.reserve(StateSize * EventSize);
+    }
+    guardCache_.clear();
+  }
+
+  void attachTransitionGuard(S state, TransitionGuard<S, E> guard,
+                             GuardPurity purity = GuardPurity::Impure) {
+    attachTransitionGuard<TransitionGuard<S, E>>(state, std::move(guard),
+                                                 purity);
+  }
+
+  // Forgets every cached pure-guard result, e.g. after the configuration
+  // those guards read has changed. Only the cache is touched, so this may
+  // be called on a shared definition; an evaluation already in flight on
+  // another thread can still store its (old) result.
+  void invalidateGuards() const noexcept { guardCache_.clear(); }
+
+  // Resource guards and callbacks are allocated from.
+  std::pmr::memory_resource *resource() const noexcept {
+    return transitionCallbacks_.get_allocator().resource;
+  }
+
+  // Runs one transition for a machine currently in `currentState`. The state
+  // is updated between the Exit and Enter callbacks, as FSM always did.
+  std::expected<S, ProcessEventErr> processEvent(S &currentState,
+                                                 E event) const {
+    const auto edge = computeEdge(currentState, event);
+    const S nextState = edge.next;
+    if (nextState == S::MAX_VALUE) {
+      return std::unexpected(ProcessEventErr::NoNextStateFound);
+    }
+
+    if (!allowsTransition(currentState, edge, event)) {
+      return std::unexpected(ProcessEventErr::TransitionForbidden);
+    }
+
+    notifyExit(currentState, nextState, event);
+    runAction(currentState, edge, event);
+
+    const S prevState = currentState;
+    currentState = nextState;
+
+    notifyEnter(prevState, nextState, event);
+
+    return nextState;
+  }
+
+  // The steps of processEvent(), for machines that commit the state change
+  // themselves (see ConcurrentFSM). A plain transition costs one flag load
+  // per step; guards and callback spans are only touched when the state's
+  // flag is set.
+  bool allowsTransition(S currentState, S nextState, E event) const {
+    const auto flags = hookFlags_[stateIndex(currentState)];
+    if (!(flags & HasGuard)) {
+      return true;
+    }
+    const auto &guard = transitionGuards_[stateIndex(currentState)];
+    if (!(flags & HasPureGuard)) {
+      return std::invoke(guard, currentState, nextState, event);
+    }
+    const auto cell = cellIndex(currentState, event);
+    if (const auto cached = guardCache_.lookup(cell)) {
+      return *cached;
+    }
+    const bool allowed = std::invoke(guard, currentState, nextState, event);
+    guardCache_.store(cell, allowed);
+    return allowed;
+  }
+
+  // The state's guard, then the edge's own guard.
+  bool allowsTransition(S currentState, const TransitionEdge<S> &edge,
+                        E event) const {
+    if (!allowsTransition(currentState, edge.next, event)) {
+      return false;
+    }
+    if constexpr (HasEdges) {
+      if (edge.guard != NoEdgeHook &&
+          edge.guard <= edgeHooks_.guards.size()) {
+        const auto &guard = edgeHooks_.guards[edge.guard - 1];
+        return !guard || std::invoke(guard, currentState, edge.next, event);
+      }
+    }
+    return true;
+  }
+
+  // The edge's action, if any; a no-op for tables without edge hooks.
+  void runAction(S currentState, const TransitionEdge<S> &edge,
+                 E event) const {
+    if constexpr (HasEdges) {
+      if (edge.action != NoEdgeHook &&
+          edge.action <= edgeHooks_.actions.size()) {
+        const auto &action = edgeHooks_.actions[edge.action - 1];
+        if (action) {
+          std::invoke(action, currentState, edge.next, event);
+        }
+      }
+    }
+  }
+
+  void notifyExit(S currentState, S nextState, E event) const {
+    if (!(hookFlags_[stateIndex(currentState)] & HasExitCallbacks)) {
+      return;
+    }
+    for (const auto &cb : callbacks(TransitionType::Exit, currentState)) {
+      if (cb) {
+        std::invoke(cb, TransitionType::Exit, currentState, nextState, event);
+      }
+    }
+  }
+
+  void notifyEnter(S prevState, S nextState, E event) const {
+    if (!(hookFlags_[stateIndex(nextState)] & HasEnterCallbacks)) {
+      return;
+    }
+    for (const auto &cb : callbacks(TransitionType::Enter, nextState)) {
+      if (cb) {
+        std::invoke(cb, TransitionType::Enter, prevState, nextState, event);
+      }
+    }
+  }
+
+  // Feeds `events` in order. Machines without guards or callbacks take a
+  // table-only loop that keeps the state in a register.
+  BatchResult processEvents(
+      S &currentState, std::span<const E> events,
+      BatchErrorPolicy policy = BatchErrorPolicy::StopOnError) const {
+    return runBatch(currentState, events, policy, [](S) {});
+  }
+
+  // As above, additionally writing the state after each consumed event
+  // (unchanged for rejected events) to `out`.
+  template <std::output_iterator<S> Out>
+  BatchResult processEvents(
+      S &currentState, std::span<const E> events, Out out,
+      BatchErrorPolicy policy = BatchErrorPolicy::StopOnError) const {
+    return runBatch(currentState, events, policy,
+                    [&out](S state) { *out++ = state; });
+  }
+
+  // Steps many machines sharing this definition, e.g. a column of
+  // FSMInstance-style states: states[i] takes events[i], and elements past
+  // the shorter span are ignored. Rejected machines keep their state.
+  //
+  // Work is done in chunks of 64 machines: all candidate transitions are
+  // looked up, then all guards are evaluated in one pass (pure guards
+  // mostly from the cache), and only then do the accepted transitions run
+  // their callbacks, in machine order. A guard therefore never sees the
+  // effects of callbacks from the same chunk.
+  BatchResult step(std::span<S> states, std::span<const E> events) const {
+    const auto count = std::min(states.size(), events.size());
+    BatchResult result{};
+    result.consumed = count;
+    const auto reject = [&result](ProcessEventErr err) {
+      ++result.failed;
+      if (!result.firstError) {
+        result.firstError = err;
+      }
+    };
+
+    if (!hasHooks()) {
+      for (std::size_t i = 0; i < count; ++i) {
+        const auto nextState = table_.lookup(states[i], events[i]);
+        if (nextState == S::MAX_VALUE) {
+          reject(ProcessEventErr::NoNextStateFound);
+        } else {
+          states[i] = nextState;
+        }
+      }
+      return result;
+    }
+
+    constexpr std::size_t Chunk = 64;
+    std::array<TransitionEdge<S>, Chunk> edges;
+    for (std::size_t base = 0; base < count; base += Chunk) {
+      const auto n = std::min(Chunk, count - base);
+      const S *from = states.data() + base;
+      const E *event = events.data() + base;
+      for (std::size_t j = 0; j < n; ++j) {
+        edges[j] = computeEdge(from[j], event[j]);
+      }
+      std::uint64_t allowed = 0;
+      for (std::size_t j = 0; j < n; ++j) {
+        if (edges[j].next != S::MAX_VALUE &&
+            allowsTransition(from[j], edges[j], event[j])) {
+          allowed |= std::uint64_t{1} << j;
+        }
+      }
+      for (std::size_t j = 0; j < n; ++j) {
+        const S nextState = edges[j].next;
+        if (!((allowed >> j) & 1U)) {
+          reject(nextState == S::MAX_VALUE
+                     ? ProcessEventErr::NoNextStateFound
+                     : ProcessEventErr::TransitionForbidden);
+          continue;
+        }
+        S &state = states[base + j];
+        const S prevState = state;
+        notifyExit(prevState, nextState, event[j]);
+        runAction(prevState, edges[j], event[j]);
+        state = nextState;
+        notifyEnter(prevState, nextState, event[j]);
+      }
+    }
+    return result;
+  }
+
+  S computeTransition(S state, E event) const {
+    return table_.lookup(state, event);
+  }
+
+  // The target and, for edge tables, the edge's hook ids, in one lookup.
+  TransitionEdge<S> computeEdge(S state, E event) const {
+    if constexpr (HasEdges) {
+      return table_.edge(state, event);
+    } else {
+      return {table_.lookup(state, event)};
+    }
+  }
+
+  const Table &table() const noexcept { return table_; }
+
+  // Replaces the table with its minimized form, reachable from `initial`
+  // (see minimize() in Minimize.hpp), and moves guards and callbacks to the
+  // renumbered states. States with hooks, and those in `keep`, are never
+  // merged; hooks of pruned states are dropped.
+  StateMap<S> minimize(S initial, std::span<const S> keep = {})
+    requires(!HasEdges)
+  {
+    std::vector<S> distinguished(keep.begin(), keep.end());
+    for (size_t s = 0; s < StateSize; ++s) {
+      if (hookFlags_[s] != 0) {
+        distinguished.push_back(static_cast<S>(s));
+      }
+    }
+    auto minimized =
+        state_machine::minimize(table_, initial,
+                                std::span<const S>(distinguished));
+
+    MachineDefinition next(minimized.table, resource());
+    for (size_t s = 0; s < StateSize; ++s) {
+      const S to = minimized.states(static_cast<S>(s));
+      if (hookFlags_[s] == 0 || to == S::MAX_VALUE) {
+        continue;
+      }
+      next.attachTransitionGuard(to, std::move(transitionGuards_[s]),
+                                 (hookFlags_[s] & HasPureGuard)
+                                     ? GuardPurity::Pure
+                                     : GuardPurity::Impure);
+      for (const auto type : {TransitionType::Enter, TransitionType::Exit}) {
+        const auto slot = callbackIndex(type, static_cast<S>(s));
+        for (auto i = callbackOffsets_[slot]; i < callbackOffsets_[slot + 1];
+             ++i) {
+          next.attachTransitionCallback(
+              type, to,
+              CallbackFn(std::move(transitionCallbacks_[i]), next.resource()));
+        }
+      }
+    }
+    *this = std::move(next);
+    return minimized.states;
+  }
+
+  // True if any guard or callback is installed, i.e. processEvent() can run
+  // user code.
+  bool hasHooks() const noexcept {
+    if constexpr (HasEdges) {
+      if (!edgeHooks_.guards.empty() || !edgeHooks_.actions.empty()) {
+        return true;
+      }
+    }
+    return anyHookFlags_ != 0;
+  }
+
+ private:
+  static constexpr size_t stateIndex(S state) noexcept {
+    return static_cast<size_t>(state);
+  }
+
+  static constexpr size_t cellIndex(S state, E event) noexcept {
+    return (stateIndex(state) * EventSize) + static_cast<size_t>(event);
+  }
+
+  static constexpr size_t typeIndex(TransitionType type) noexcept {
+    switch (type) {
+    case TransitionType::Enter:
+      return 0;
+    case TransitionType::Exit:
+      return 1;
+    }
+    return 0;
+  }
+
+  static constexpr size_t callbackIndex(TransitionType type, S state) noexcept {
+    return (typeIndex(type) * StateSize) + stateIndex(state);
+  }
+
+  void setHookFlag(S state, std::uint8_t flag, bool present) noexcept {
+    auto &flags = hookFlags_[stateIndex(state)];
+    flags = static_cast<std::uint8_t>(present ? (flags | flag)
+                                              : (flags & ~flag));
+    anyHookFlags_ = 0;
+    for (const auto f : hookFlags_) {
+      anyHookFlags_ |= f;
+    }
+  }
+
+  template <typename Emit>
+  BatchResult runBatch(S &currentState, std::span<const E> events,
+                       BatchErrorPolicy policy, Emit &&emit) const {
+    BatchResult result{};
+    const auto reject = [&](ProcessEventErr err) {
+      ++result.failed;
+      if (!result.firstError) {
+        result.firstError = err;
+      }
+      return policy == BatchErrorPolicy::StopOnError;
+    };
+
+    if (!hasHooks()) {
+      S state = currentState;
+      for (const E event : events) {
+        ++result.consumed;
+        const auto nextState = table_.lookup(state, event);
+        const bool rejected = nextState == S::MAX_VALUE;
+        if (!rejected) {
+          state = nextState;
+        }
+        emit(state);
+        if (rejected && reject(ProcessEventErr::NoNextStateFound)) {
+          break;
+        }
+      }
+      currentState = state;
+      return result;
+    }
+
+    for (const E event : events) {
+      ++result.consumed;
+      const auto r = processEvent(currentState, event);
+      emit(currentState);
+      if (!r && reject(r.error())) {
+        break;
+      }
+    }
+    return result;
+  }
+
+  void attachTransitionCallback(TransitionType type, S state,
+                                CallbackFn callback) {
+    // Keep each slot's callbacks contiguous and in attach order: insert at
+    // the slot's end and shift the offsets of every later slot.
+    const auto slot = callbackIndex(type, state);
+    if (callback) {
+      setHookFlag(state,
+                  type == TransitionType::Exit ? HasExitCallbacks
+                                               : HasEnterCallbacks,
+                  true);
+    }
+    transitionCallbacks_.insert(
+        transitionCallbacks_.begin() + callbackOffsets_[slot + 1],
+        std::move(callback));
+    for (auto i = slot + 1; i < callbackOffsets_.size(); ++i) {
+      ++callbackOffsets_[i];
+    }
+  }
+
+  std::span<const CallbackFn>
+  callbacks(TransitionType type, S state) const noexcept {
+    const auto slot = callbackIndex(type, state);
+    return std::span(transitionCallbacks_)
+        .subspan(callbackOffsets_[slot],
+                 callbackOffsets_[slot + 1] - callbackOffsets_[slot]);
+  }
+
+ private:
+  static constexpr auto StateSize = enum_utils::enum_size_v<S>;
+  static constexpr auto EventSize = enum_utils::enum_size_v<E>;
+  static constexpr auto CallbackSlotCount = 2 * StateSize;
+
+  // Empty guards on the default resource are left alone: default
+  // construction and init() stay as cheap as for a plain array.
+  void adoptGuardResource() {
+    if (resource() != std::pmr::get_default_resource()) {
+      for (auto &guard : transitionGuards_) {
+        guard = GuardFn(resource());
+      }
+    }
+  }
+
+  template <typename Hooks, typename Fn>
+  EdgeHookId addEdgeHook(Hooks &hooks, Fn hook) {
+    if (hooks.size() == std::numeric_limits<EdgeHookId>::max()) {
+      return NoEdgeHook;
+    }
+    hooks.push_back(std::move(hook));
+    return static_cast<EdgeHookId>(hooks.size());
+  }
+
+  void resetGuards() {
+    for (auto &guard : transitionGuards_) {
+      if (guard) {
+        guard = GuardFn(guard.resource());
+      }
+    }
+  }
+
+  Table table_{};
+
+  // All callbacks in one buffer, grouped by slot (CSR layout): slot i owns
+  // [callbackOffsets_[i], callbackOffsets_[i + 1]).
+  std::vector<CallbackFn, CallbackAllocator> transitionCallbacks_{};
+  std::array<std::uint32_t, CallbackSlotCount + 1> callbackOffsets_{};
+
+  std::array<GuardFn, StateSize> transitionGuards_{};
+  detail::GuardCache guardCache_{};
+  [[no_unique_address]] std::conditional_t<
+      HasEdges, detail::EdgeHooks<GuardFn, ActionFn>, detail::NoEdgeHooks>
+      edgeHooks_{};
+
+  // Per-state summary of attached hooks, checked before touching the guard
+  // or callback storage.
+  static constexpr std::uint8_t HasGuard = 1U << 0;
+  static constexpr std::uint8_t HasExitCallbacks = 1U << 1;
+  static constexpr std::uint8_t HasEnterCallbacks = 1U << 2;
+  static constexpr std::uint8_t HasPureGuard = 1U << 3;
+  std::array<std::uint8_t, StateSize> hookFlags_{};
+  std::uint8_t anyHookFlags_{};
+};
+
+} // namespace state_machine
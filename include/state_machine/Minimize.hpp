@@ -0,0 +1,243 @@
+#pragma once
+
+#include "EnumUtils.hpp"
+#include "TransitionTable.hpp"
+#include "Types.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace state_machine {
+
+// Old-to-new state numbering produced by minimize(). Surviving states are
+// renumbered densely, 0..count-1, in breadth-first order from the initial
+// state (which becomes 0); pruned states map to S::MAX_VALUE.
+template <StateID S> struct StateMap {
+  std::array<S, enum_utils::enum_size_v<S>> newState{};
+  std::size_t count{};
+
+  constexpr S operator()(S old) const noexcept {
+    return newState[static_cast<std::size_t>(old)];
+  }
+};
+
+template <TransitionTableBackend Table> struct MinimizedTable {
+  Table table{};
+  StateMap<typename Table::State> states{};
+};
+
+// Minimizes the machine reachable from `initial`:
+//  - states unreachable from `initial` are dropped;
+//  - states with the same behaviour (same accepted events, leading to
+//    equivalent states) are merged, using Hopcroft's partition refinement;
+//  - states listed in `distinguished` (e.g. states with guards or
+//    callbacks, or states the application compares getCurrentState()
+//    against) are never merged with another state.
+// The result uses the dense numbering described by StateMap, so its hot
+// rows sit at the start of the table. Missing transitions count as moves
+// to an implicit dead state, which keeps rejected events rejected.
+template <TransitionTableBackend Table>
+MinimizedTable<Table>
+minimize(const Table &table, typename Table::State initial,
+         std::span<const typename Table::State> distinguished = {}) {
+  using S = typename Table::State;
+  using E = typename Table::Event;
+  constexpr std::size_t StateSize = enum_utils::enum_size_v<S>;
+  constexpr std::size_t EventSize = enum_utils::enum_size_v<E>;
+  // Index StateSize is the dead state; it is also the "unreachable" marker.
+  constexpr std::size_t Dead = StateSize;
+  constexpr std::size_t N = StateSize + 1;
+
+  const auto next = [&](std::size_t s, std::size_t e) -> std::size_t {
+    if (s == Dead) {
+      return Dead;
+    }
+    const S to = table.lookup(static_cast<S>(s), static_cast<E>(e));
+    return to == S::MAX_VALUE ? Dead : static_cast<std::size_t>(to);
+  };
+
+  // Reachability, in BFS order (this order also numbers the result).
+  std::vector<std::size_t> order{static_cast<std::size_t>(initial)};
+  std::vector<bool> reachable(N, false);
+  reachable[order[0]] = true;
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    for (std::size_t e = 0; e < EventSize; ++e) {
+      const auto to = next(order[i], e);
+      if (to != Dead && !reachable[to]) {
+        reachable[to] = true;
+        order.push_back(to);
+      }
+    }
+  }
+  reachable[Dead] = true;
+
+  // Predecessor lists per event, restricted to reachable states (CSR).
+  std::vector<std::uint32_t> predOffsets((N * EventSize) + 1, 0);
+  for (std::size_t s = 0; s < N; ++s) {
+    if (reachable[s]) {
+      for (std::size_t e = 0; e < EventSize; ++e) {
+        ++predOffsets[(next(s, e) * EventSize) + e + 1];
+      }
+    }
+  }
+  for (std::size_t i = 1; i < predOffsets.size(); ++i) {
+    predOffsets[i] += predOffsets[i - 1];
+  }
+  std::vector<std::uint32_t> preds(predOffsets.back());
+  {
+    auto fill = predOffsets;
+    for (std::size_t s = 0; s < N; ++s) {
+      if (reachable[s]) {
+        for (std::size_t e = 0; e < EventSize; ++e) {
+          preds[fill[(next(s, e) * EventSize) + e]++] =
+              static_cast<std::uint32_t>(s);
+        }
+      }
+    }
+  }
+
+  // Refinable partition: each block is a contiguous range of `elems`, with
+  // its marked states moved to the front of the range while splitting.
+  std::vector<std::uint32_t> elems;
+  std::vector<std::uint32_t> position(N, 0);
+  std::vector<std::uint32_t> blockOf(N, 0);
+  std::vector<std::uint32_t> blockBegin;
+  std::vector<std::uint32_t> blockEnd;
+  std::vector<std::uint32_t> markedEnd;
+  std::vector<bool> inWorklist;
+  std::vector<std::uint32_t> worklist;
+
+  const auto addBlock = [&](std::uint32_t begin, std::uint32_t end) {
+    const auto b = static_cast<std::uint32_t>(blockBegin.size());
+    blockBegin.push_back(begin);
+    blockEnd.push_back(end);
+    markedEnd.push_back(begin);
+    inWorklist.push_back(false);
+    for (auto i = begin; i < end; ++i) {
+      blockOf[elems[i]] = b;
+    }
+    return b;
+  };
+  const auto pushWork = [&](std::uint32_t b) {
+    if (!inWorklist[b]) {
+      inWorklist[b] = true;
+      worklist.push_back(b);
+    }
+  };
+
+  // Initial partition: the dead state, each distinguished state, and one
+  // block with every other reachable state.
+  std::vector<bool> isDistinguished(N, false);
+  for (const S s : distinguished) {
+    isDistinguished[static_cast<std::size_t>(s)] = true;
+  }
+  const auto place = [&](std::size_t s) {
+    position[s] = static_cast<std::uint32_t>(elems.size());
+    elems.push_back(static_cast<std::uint32_t>(s));
+  };
+  place(Dead);
+  pushWork(addBlock(0, 1));
+  for (const auto s : order) {
+    if (isDistinguished[s]) {
+      const auto begin = static_cast<std::uint32_t>(elems.size());
+      place(s);
+      pushWork(addBlock(begin, begin + 1));
+    }
+  }
+  {
+    const auto begin = static_cast<std::uint32_t>(elems.size());
+    for (const auto s : order) {
+      if (!isDistinguished[s]) {
+        place(s);
+      }
+    }
+    const auto end = static_cast<std::uint32_t>(elems.size());
+    if (end != begin) {
+      pushWork(addBlock(begin, end));
+    }
+  }
+
+  // Hopcroft: split every block by the predecessors of each splitter, then
+  // queue either both halves (splitter already pending) or the smaller one.
+  std::vector<std::uint32_t> touched;
+  std::vector<std::uint32_t> splitter;
+  while (!worklist.empty()) {
+    const auto c = worklist.back();
+    worklist.pop_back();
+    inWorklist[c] = false;
+    splitter.assign(elems.begin() + blockBegin[c], elems.begin() + blockEnd[c]);
+
+    for (std::size_t e = 0; e < EventSize; ++e) {
+      for (const auto q : splitter) {
+        const auto slot = (q * EventSize) + e;
+        for (auto i = predOffsets[slot]; i < predOffsets[slot + 1]; ++i) {
+          const auto p = preds[i];
+          const auto b = blockOf[p];
+          if (position[p] < markedEnd[b]) {
+            continue;
+          }
+          if (markedEnd[b] == blockBegin[b]) {
+            touched.push_back(b);
+          }
+          // Swap p to the end of the marked prefix.
+          const auto dest = markedEnd[b]++;
+          const auto other = elems[dest];
+          std::swap(elems[dest], elems[position[p]]);
+          position[other] = position[p];
+          position[p] = dest;
+        }
+      }
+
+      for (const auto b : touched) {
+        const auto begin = blockBegin[b];
+        const auto split = markedEnd[b];
+        markedEnd[b] = begin;
+        if (split == blockEnd[b]) {
+          continue;
+        }
+        // Marked prefix becomes a new block; b keeps the rest.
+        blockBegin[b] = split;
+        markedEnd[b] = split;
+        const auto nb = addBlock(begin, split);
+        if (inWorklist[b]) {
+          pushWork(nb);
+        } else {
+          pushWork(split - begin <= blockEnd[b] - split ? nb : b);
+        }
+      }
+      touched.clear();
+    }
+  }
+
+  // Number the surviving blocks in BFS order and emit one row per block.
+  MinimizedTable<Table> result{};
+  result.states.newState.fill(S::MAX_VALUE);
+  std::vector<S> blockState(blockBegin.size(), S::MAX_VALUE);
+  std::vector<std::size_t> representatives;
+  for (const auto s : order) {
+    auto &id = blockState[blockOf[s]];
+    if (id == S::MAX_VALUE) {
+      id = static_cast<S>(representatives.size());
+      representatives.push_back(s);
+    }
+    result.states.newState[s] = id;
+  }
+  result.states.count = representatives.size();
+
+  for (std::size_t r = 0; r < representatives.size(); ++r) {
+    for (std::size_t e = 0; e < EventSize; ++e) {
+      const auto to = next(representatives[r], e);
+      if (to != Dead) {
+        result.table.enable(static_cast<S>(r), blockState[blockOf[to]],
+                            static_cast<E>(e));
+      }
+    }
+  }
+  return result;
+}
+
+} // namespace state_machine
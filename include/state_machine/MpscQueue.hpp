@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace state_machine {
+
+// Bounded lock-free multi-producer / single-consumer FIFO. Each cell carries
+// a sequence number (Vyukov's bounded queue), so producers only contend on
+// one fetch of the head index and never wait for each other.
+//
+// tryPush() may be called from any thread; tryPop() and empty() only from
+// the single consumer.
+template <typename T, std::size_t Capacity> class MpscQueue {
+  static_assert(std::has_single_bit(Capacity),
+                "Capacity must be a power of two");
+  static_assert(std::is_nothrow_move_constructible_v<T> &&
+                    std::is_default_constructible_v<T>,
+                "T must be default constructible and nothrow movable");
+
+ public:
+  MpscQueue() noexcept {
+    for (std::size_t i = 0; i < Capacity; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue &operator=(const MpscQueue &) = delete;
+
+  // Returns false when the queue is full.
+  bool tryPush(T value) noexcept {
+    auto pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      auto &cell = cells_[pos & Mask];
+      const auto seq = cell.sequence.load(std::memory_order_acquire);
+      const auto diff =
+          static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          cell.value = std::move(value);
+          cell.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::optional<T> tryPop() noexcept {
+    auto &cell = cells_[tail_ & Mask];
+    const auto seq = cell.sequence.load(std::memory_order_acquire);
+    if (seq != tail_ + 1) {
+      return std::nullopt;
+    }
+    std::optional<T> value(std::move(cell.value));
+    cell.sequence.store(tail_ + Capacity, std::memory_order_release);
+    ++tail_;
+    return value;
+  }
+
+  bool empty() const noexcept {
+    return cells_[tail_ & Mask].sequence.load(std::memory_order_acquire) !=
+           tail_ + 1;
+  }
+
+  static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+ private:
+  static constexpr std::size_t Mask = Capacity - 1;
+  static constexpr std::size_t CacheLine = 64;
+
+  struct Cell {
+    std::atomic<std::size_t> sequence;
+    T value{};
+  };
+
+  alignas(CacheLine) std::atomic<std::size_t> head_{0};
+  alignas(CacheLine) std::size_t tail_{0};
+  alignas(CacheLine) std::array<Cell, Capacity> cells_;
+};
+
+} // namespace state_machine
@@ -0,0 +1,256 @@
+#pragma once
+
+#include "EnumUtils.hpp"
+#include "TransitionTable.hpp"
+#include "Types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace state_machine {
+
+namespace detail {
+
+template <unsigned Bits>
+using PackedWord = std::conditional_t<
+    Bits <= 8, std::uint8_t,
+    std::conditional_t<Bits <= 16, std::uint16_t,
+                       std::conditional_t<Bits <= 32, std::uint32_t,
+                                          std::uint64_t>>>;
+
+// Packs one state per region into a single word, each region in its own
+// bit field of bit_width(StateSize - 1) bits, so reading a region is a shift
+// and a mask.
+template <typename... Tables> struct RegionLayout {
+  static constexpr std::size_t Count = sizeof...(Tables);
+
+  template <std::size_t I>
+  using Table = std::tuple_element_t<I, std::tuple<Tables...>>;
+  template <std::size_t I> using State = typename Table<I>::State;
+  using Event = typename Table<0>::Event;
+
+  static constexpr std::array<unsigned, Count> Bits{static_cast<unsigned>(
+      std::max<int>(1, std::bit_width(enum_utils::enum_size_v<
+                                          typename Tables::State> -
+                                      1)))...};
+
+  static constexpr std::array<unsigned, Count> Shifts = [] {
+    std::array<unsigned, Count> shifts{};
+    for (std::size_t i = 1; i < Count; ++i) {
+      shifts[i] = shifts[i - 1] + Bits[i - 1];
+    }
+    return shifts;
+  }();
+
+  static constexpr unsigned TotalBits = Shifts[Count - 1] + Bits[Count - 1];
+  static_assert(TotalBits <= 63, "Regions do not fit in one 64-bit word");
+
+  using Packed = PackedWord<TotalBits>;
+
+  template <std::size_t I>
+  static constexpr Packed FieldMask =
+      static_cast<Packed>(((Packed{1} << Bits[I]) - 1) << Shifts[I]);
+
+  template <std::size_t I>
+  static constexpr State<I> get(Packed word) noexcept {
+    return static_cast<State<I>>((word & FieldMask<I>) >> Shifts[I]);
+  }
+
+  template <std::size_t I>
+  static constexpr Packed set(Packed word, State<I> state) noexcept {
+    return static_cast<Packed>(
+        (word & ~FieldMask<I>) |
+        (static_cast<Packed>(std::to_underlying(state)) << Shifts[I]));
+  }
+
+  // Feeds `event` to every region of `word`; regions without a transition
+  // keep their state. Returns whether any region transitioned.
+  static constexpr bool step(const std::tuple<const Tables &...> &tables,
+                             Packed &word, Event event) {
+    bool moved = false;
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+      (stepRegion<I>(std::get<I>(tables), word, event, moved), ...);
+    }(std::index_sequence_for<Tables...>{});
+    return moved;
+  }
+
+  template <std::size_t I>
+  static constexpr bool valid(Packed word) noexcept {
+    return static_cast<std::size_t>(get<I>(word)) <
+           enum_utils::enum_size_v<State<I>>;
+  }
+
+  static constexpr bool valid(Packed word) noexcept {
+    return [&]<std::size_t... I>(std::index_sequence<I...>) {
+      return (valid<I>(word) && ...);
+    }(std::index_sequence_for<Tables...>{});
+  }
+
+ private:
+  template <std::size_t I>
+  static constexpr void stepRegion(const Table<I> &table, Packed &word,
+                                   Event event, bool &moved) {
+    const auto next = table.lookup(get<I>(word), event);
+    if (next != State<I>::MAX_VALUE) {
+      word = set<I>(word, next);
+      moved = true;
+    }
+  }
+};
+
+template <typename... Tables>
+concept ParallelRegions =
+    sizeof...(Tables) > 0 && (TransitionTableBackend<Tables> && ...) &&
+    (std::same_as<typename Tables::Event,
+                  typename std::tuple_element_t<
+                      0, std::tuple<Tables...>>::Event> &&
+     ...);
+
+} // namespace detail
+
+// Orthogonal regions run in lockstep: every event is fed to each region's
+// table, and all region states live in one packed word (see state<I>() and
+// packed()). A region without a transition for the event keeps its state;
+// processEvent() fails with NoNextStateFound only if no region moved.
+//
+// Regions are bare tables: there are no per-region guards or callbacks.
+template <typename... Tables>
+  requires detail::ParallelRegions<Tables...>
+class ParallelFSM {
+  using Layout = detail::RegionLayout<Tables...>;
+
+ public:
+  using Event = typename Layout::Event;
+  using Packed = typename Layout::Packed;
+  template <std::size_t I> using State = typename Layout::template State<I>;
+
+  static constexpr std::size_t RegionCount = Layout::Count;
+
+  ParallelFSM(Tables... tables, typename Tables::State... initial)
+      : tables_(std::move(tables)...), packed_(pack(initial...)) {}
+
+  std::expected<Packed, ProcessEventErr> processEvent(Event event) {
+    Packed next = packed_;
+    if (!Layout::step(tables_, next, event)) {
+      return std::unexpected(ProcessEventErr::NoNextStateFound);
+    }
+    packed_ = next;
+    return packed_;
+  }
+
+  template <std::size_t I> State<I> state() const noexcept {
+    return Layout::template get<I>(packed_);
+  }
+
+  template <std::size_t I> void setState(State<I> state) noexcept {
+    packed_ = Layout::template set<I>(packed_, state);
+  }
+
+  Packed packed() const noexcept { return packed_; }
+
+  template <std::size_t I> static constexpr State<I> unpack(Packed word) {
+    return Layout::template get<I>(word);
+  }
+
+  static constexpr Packed pack(typename Tables::State... states) noexcept {
+    Packed word{};
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+      ((word = Layout::template set<I>(word, states)), ...);
+    }(std::index_sequence_for<Tables...>{});
+    return word;
+  }
+
+  template <std::size_t I> const auto &table() const noexcept {
+    return std::get<I>(tables_);
+  }
+
+ private:
+  std::tuple<Tables...> tables_;
+  Packed packed_;
+};
+
+// ParallelFSM over compile-time tables, fused into one product table: one
+// cell per (packed word, event) holding the next packed word plus a "moved"
+// bit. A step over any number of regions is a single load. Meant for small
+// regions; the product table is capped at 2^16 cells.
+template <auto... Tables>
+  requires(is_transition_table_v<decltype(Tables)> && ...) &&
+          detail::ParallelRegions<std::remove_cvref_t<decltype(Tables)>...>
+class StaticParallelFSM {
+  using Layout = detail::RegionLayout<std::remove_cvref_t<decltype(Tables)>...>;
+
+ public:
+  using Event = typename Layout::Event;
+  using Packed = typename Layout::Packed;
+  template <std::size_t I> using State = typename Layout::template State<I>;
+
+  static constexpr std::size_t RegionCount = Layout::Count;
+
+ private:
+  static constexpr auto EventSize = enum_utils::enum_size_v<Event>;
+  static constexpr std::size_t WordCount = std::size_t{1}
+                                           << Layout::TotalBits;
+  static_assert(WordCount * EventSize <= (std::size_t{1} << 16),
+                "Product table too large; use ParallelFSM");
+
+  using Cell = detail::PackedWord<Layout::TotalBits + 1>;
+  static constexpr auto Moved = static_cast<Cell>(Cell{1} << Layout::TotalBits);
+
+  static constexpr auto Fused = [] {
+    std::array<Cell, WordCount * EventSize> cells{};
+    const auto tables = std::tie(Tables...);
+    for (std::size_t w = 0; w < WordCount; ++w) {
+      const auto word = static_cast<Packed>(w);
+      for (std::size_t e = 0; e < EventSize; ++e) {
+        Packed next = word;
+        const bool moved =
+            Layout::valid(word) &&
+            Layout::step(tables, next, static_cast<Event>(e));
+        cells[(w * EventSize) + e] =
+            moved ? static_cast<Cell>(Moved | next) : Cell{};
+      }
+    }
+    return cells;
+  }();
+
+ public:
+  constexpr StaticParallelFSM(
+      typename std::remove_cvref_t<decltype(Tables)>::State... initial) noexcept
+      : packed_(ParallelFSM<std::remove_cvref_t<decltype(Tables)>...>::pack(
+            initial...)) {}
+
+  constexpr std::expected<Packed, ProcessEventErr>
+  processEvent(Event event) noexcept {
+    const Cell cell =
+        Fused[(static_cast<std::size_t>(packed_) * EventSize) +
+              static_cast<std::size_t>(event)];
+    if (!(cell & Moved)) {
+      return std::unexpected(ProcessEventErr::NoNextStateFound);
+    }
+    packed_ = static_cast<Packed>(cell & ~Moved);
+    return packed_;
+  }
+
+  template <std::size_t I> constexpr State<I> state() const noexcept {
+    return Layout::template get<I>(packed_);
+  }
+
+  constexpr Packed packed() const noexcept { return packed_; }
+
+  static constexpr std::size_t fusedCellCount() noexcept {
+    return Fused.size();
+  }
+
+ private:
+  Packed packed_;
+};
+
+} // namespace state_machine
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace state_machine {
+
+namespace detail {
+
+template <typename T> struct is_std_function : std::false_type {};
+template <typename Sig>
+struct is_std_function<std::function<Sig>> : std::true_type {};
+
+// Allocator over a memory_resource pointer with the semantics FSM wants for
+// its storage: moves take the resource along (so moves never allocate and
+// are noexcept), copies start on the default resource (a copy may outlive
+// the arena), and copy assignment keeps the target's resource.
+template <typename T> struct ResourceAllocator {
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  ResourceAllocator() noexcept = default;
+  ResourceAllocator(std::pmr::memory_resource *resource) noexcept
+      : resource(resource) {}
+  template <typename U>
+  ResourceAllocator(const ResourceAllocator<U> &other) noexcept
+      : resource(other.resource) {}
+
+  T *allocate(std::size_t n) {
+    return static_cast<T *>(resource->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *p, std::size_t n) noexcept {
+    resource->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  ResourceAllocator select_on_container_copy_construction() const noexcept {
+    return {};
+  }
+
+  template <typename U>
+  friend bool operator==(const ResourceAllocator &a,
+                         const ResourceAllocator<U> &b) noexcept {
+    return a.resource == b.resource || a.resource->is_equal(*b.resource);
+  }
+
+  std::pmr::memory_resource *resource = std::pmr::get_default_resource();
+};
+
+} // namespace detail
+
+template <typename Signature> class PmrFunction;
+
+// Owns a copy of a callable, like std::function, but allocates it from a
+// memory_resource; FSM and MachineDefinition keep their guards and
+// callbacks in it. Targets that fit InlineSize (including a whole
+// std::function) and are nothrow-movable are stored inline and never
+// allocate. Resource propagation follows detail::ResourceAllocator: moves
+// carry the resource, copies use the default resource unless one is given,
+// copy assignment keeps the target's.
+template <typename R, typename... Args> class PmrFunction<R(Args...)> {
+ public:
+  static constexpr std::size_t InlineSize = sizeof(std::function<R(Args...)>);
+
+  PmrFunction() noexcept = default;
+
+  explicit PmrFunction(std::pmr::memory_resource *resource) noexcept
+      : resource_(resource) {}
+
+  PmrFunction(std::nullptr_t) noexcept {}
+
+  // Null function pointers and empty std::functions give an empty wrapper.
+  template <typename F>
+    requires(!std::same_as<std::remove_cvref_t<F>, PmrFunction> &&
+             std::copy_constructible<std::decay_t<F>> &&
+             std::is_invocable_r_v<R, std::decay_t<F> &, Args...>)
+  PmrFunction(F &&f, std::pmr::memory_resource *resource =
+                         std::pmr::get_default_resource())
+      : resource_(resource) {
+    using Target = std::decay_t<F>;
+    if constexpr (std::is_pointer_v<Target> ||
+                  std::is_member_pointer_v<Target> ||
+                  detail::is_std_function<Target>::value) {
+      if (!f) {
+        return;
+      }
+    }
+    emplace<Target>(std::forward<F>(f));
+  }
+
+  PmrFunction(const PmrFunction &other)
+      : PmrFunction(other, std::pmr::get_default_resource()) {}
+
+  PmrFunction(const PmrFunction &other, std::pmr::memory_resource *resource)
+      : resource_(resource) {
+    if (other.ops_ != nullptr) {
+      other.ops_->copy(other, *this);
+    }
+  }
+
+  PmrFunction(PmrFunction &&other) noexcept : resource_(other.resource_) {
+    steal(other);
+  }
+
+  // Moves the target into `resource`; only allocates if the resources
+  // differ.
+  PmrFunction(PmrFunction &&other, std::pmr::memory_resource *resource)
+      : resource_(resource) {
+    if (sameResource(other)) {
+      steal(other);
+    } else if (other.ops_ != nullptr) {
+      other.ops_->moveInto(other, *this);
+      other.reset();
+    }
+  }
+
+  PmrFunction &operator=(const PmrFunction &other) {
+    if (this != &other) {
+      PmrFunction copy(other, resource());
+      reset();
+      steal(copy);
+    }
+    return *this;
+  }
+
+  PmrFunction &operator=(PmrFunction &&other) noexcept {
+    if (this != &other) {
+      reset();
+      resource_ = other.resource_;
+      steal(other);
+    }
+    return *this;
+  }
+
+  ~PmrFunction() { reset(); }
+
+  explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+  R operator()(Args... args) const {
+    if (ops_ == nullptr) {
+      throw std::bad_function_call();
+    }
+    return ops_->invoke(target(), std::forward<Args>(args)...);
+  }
+
+  std::pmr::memory_resource *resource() const noexcept {
+    return resource_ != nullptr ? resource_ : std::pmr::get_default_resource();
+  }
+
+ private:
+  struct Ops {
+    R (*invoke)(void *target, Args &&...args);
+    void (*copy)(const PmrFunction &from, PmrFunction &to);
+    void (*moveInto)(PmrFunction &from, PmrFunction &to);
+    // Moves an inline target between buffers; null for heap targets.
+    void (*relocate)(void *from, void *to) noexcept;
+    void (*destroy)(void *target,
+                    std::pmr::memory_resource *resource) noexcept;
+  };
+
+  template <typename F>
+  static constexpr bool StoredInline =
+      sizeof(F) <= InlineSize && alignof(F) <= alignof(void *) &&
+      std::is_nothrow_move_constructible_v<F>;
+
+  template <typename F, typename... CtorArgs>
+  void emplace(CtorArgs &&...ctorArgs) {
+    if constexpr (StoredInline<F>) {
+      ::new (static_cast<void *>(storage_)) F(
+          std::forward<CtorArgs>(ctorArgs)...);
+    } else {
+      resource_ = resource();
+      void *memory = resource_->allocate(sizeof(F), alignof(F));
+      try {
+        ::new (memory) F(std::forward<CtorArgs>(ctorArgs)...);
+      } catch (...) {
+        resource_->deallocate(memory, sizeof(F), alignof(F));
+        throw;
+      }
+      ::new (static_cast<void *>(storage_)) void *(memory);
+    }
+    ops_ = &OpsFor<F>;
+  }
+
+  void *target() const noexcept {
+    auto *self = const_cast<PmrFunction *>(this);
+    return ops_->relocate != nullptr ? static_cast<void *>(self->storage_)
+                                     : self->heapTarget();
+  }
+
+  void *&heapTarget() noexcept {
+    return *std::launder(reinterpret_cast<void **>(storage_));
+  }
+
+  template <typename F>
+  static void relocateInline(void *from, void *to) noexcept {
+    ::new (to) F(std::move(*static_cast<F *>(from)));
+    static_cast<F *>(from)->~F();
+  }
+
+  template <typename F> static constexpr Ops OpsFor{
+      [](void *target, Args &&...args) -> R {
+        return std::invoke_r<R>(*static_cast<F *>(target),
+                                std::forward<Args>(args)...);
+      },
+      [](const PmrFunction &from, PmrFunction &to) {
+        to.template emplace<F>(*static_cast<const F *>(from.target()));
+      },
+      [](PmrFunction &from, PmrFunction &to) {
+        to.template emplace<F>(
+            std::move(*static_cast<F *>(from.target())));
+      },
+      StoredInline<F> ? &relocateInline<F> : nullptr,
+      [](void *target, std::pmr::memory_resource *resource) noexcept {
+        static_cast<F *>(target)->~F();
+        if constexpr (!StoredInline<F>) {
+          resource->deallocate(target, sizeof(F), alignof(F));
+        }
+      }};
+
+  // Takes other's target; resource_ must already be other's (or equal). A
+  // heap target brings the resource it was allocated from.
+  void steal(PmrFunction &other) noexcept {
+    if (other.ops_ == nullptr) {
+      return;
+    }
+    if (other.ops_->relocate != nullptr) {
+      other.ops_->relocate(other.storage_, storage_);
+    } else {
+      resource_ = other.resource();
+      ::new (static_cast<void *>(storage_)) void *(other.heapTarget());
+    }
+    ops_ = std::exchange(other.ops_, nullptr);
+  }
+
+  void reset() noexcept {
+    if (ops_ != nullptr) {
+      ops_->destroy(target(), resource());
+      ops_ = nullptr;
+    }
+  }
+
+  bool sameResource(const PmrFunction &other) const noexcept {
+    return resource() == other.resource() ||
+           resource()->is_equal(*other.resource());
+  }
+
+  const Ops *ops_ = nullptr;
+  // Null until needed means the default resource; a heap target always
+  // records the resource it came from.
+  std::pmr::memory_resource *resource_ = nullptr;
+  alignas(void *) std::byte storage_[InlineSize];
+};
+
+} // namespace state_machine
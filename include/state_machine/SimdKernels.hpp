@@ -0,0 +1,215 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+    (defined(__GNUC__) || defined(__clang__))
+#define STATE_MACHINE_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define STATE_MACHINE_X86_KERNELS 0
+#endif
+
+namespace state_machine {
+
+// Vectorised bulk-transition kernels used by FSMPool. x86-64 builds with
+// GCC or Clang get AVX2 and AVX-512 variants selected at runtime; other
+// targets only use the scalar loop.
+enum class SimdLevel {
+  Scalar,
+  Avx2,
+  Avx512,
+};
+
+// Best level supported by the running CPU.
+inline SimdLevel detectSimdLevel() noexcept {
+#if STATE_MACHINE_X86_KERNELS
+  static const SimdLevel level = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") &&
+        __builtin_cpu_supports("avx512bw")) {
+      return SimdLevel::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return SimdLevel::Avx2;
+    }
+    return SimdLevel::Scalar;
+  }();
+  return level;
+#else
+  return SimdLevel::Scalar;
+#endif
+}
+
+namespace detail {
+
+// Tables of at most 16 cells (with the event stride rounded up to a power
+// of two) fit in one register and are looked up with a byte shuffle instead
+// of a gather.
+template <std::size_t StateSize, std::size_t EventSize>
+inline constexpr std::size_t ShuffleStride = std::bit_ceil(EventSize);
+
+template <std::size_t StateSize, std::size_t EventSize>
+inline constexpr bool ShuffleEligible =
+    StateSize * ShuffleStride<StateSize, EventSize> <= 16;
+
+template <typename T>
+inline constexpr bool GatherableWidth =
+    sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4;
+
+#if STATE_MACHINE_X86_KERNELS
+
+// Shuffle kernels: states and events are single bytes and `table` holds 16
+// resolved cells laid out as [state << Shift | event].
+template <int Shift>
+__attribute__((target("avx2"))) inline std::size_t
+shuffleStepAvx2(std::uint8_t *states, const std::uint8_t *events,
+                std::size_t count, const std::uint8_t *table) noexcept {
+  const __m256i lut = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(table)));
+  std::size_t i = 0;
+  for (; i + 32 <= count; i += 32) {
+    const __m256i s =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(states + i));
+    const __m256i e =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(events + i));
+    // Every cell index is < 16, so shifting 16-bit lanes never carries bits
+    // into the neighbouring byte.
+    const __m256i idx = _mm256_or_si256(_mm256_slli_epi16(s, Shift), e);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(states + i),
+                        _mm256_shuffle_epi8(lut, idx));
+  }
+  return i;
+}
+
+template <int Shift>
+__attribute__((target("avx512f,avx512bw"))) inline std::size_t
+shuffleStepAvx512(std::uint8_t *states, const std::uint8_t *events,
+                  std::size_t count, const std::uint8_t *table) noexcept {
+  const __m512i lut = _mm512_broadcast_i32x4(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(table)));
+  std::size_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    const __m512i s = _mm512_loadu_si512(states + i);
+    const __m512i e = _mm512_loadu_si512(events + i);
+    const __m512i idx = _mm512_or_si512(_mm512_slli_epi16(s, Shift), e);
+    _mm512_storeu_si512(states + i, _mm512_shuffle_epi8(lut, idx));
+  }
+  return i;
+}
+
+template <std::size_t Width>
+__attribute__((target("avx2"))) inline __m256i
+load8x32(const void *ptr) noexcept {
+  if constexpr (Width == 1) {
+    return _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(static_cast<const __m128i *>(ptr)));
+  } else if constexpr (Width == 2) {
+    return _mm256_cvtepu16_epi32(
+        _mm_loadu_si128(static_cast<const __m128i *>(ptr)));
+  } else {
+    return _mm256_loadu_si256(static_cast<const __m256i *>(ptr));
+  }
+}
+
+template <std::size_t Width>
+__attribute__((target("avx2"))) inline void store8x32(void *ptr,
+                                                      __m256i v) noexcept {
+  if constexpr (Width == 1) {
+    const __m256i bytes = _mm256_shuffle_epi8(
+        v, _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                            -1, -1, -1, 0, 4, 8, 12, -1, -1, -1, -1, -1, -1,
+                            -1, -1, -1, -1, -1, -1));
+    const __m256i packed = _mm256_permutevar8x32_epi32(
+        bytes, _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1, 1));
+    _mm_storel_epi64(static_cast<__m128i *>(ptr),
+                     _mm256_castsi256_si128(packed));
+  } else if constexpr (Width == 2) {
+    const __m256i halves = _mm256_shuffle_epi8(
+        v, _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1,
+                            -1, -1, 0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1,
+                            -1, -1, -1, -1));
+    const __m256i packed = _mm256_permute4x64_epi64(halves, 0b1000);
+    _mm_storeu_si128(static_cast<__m128i *>(ptr),
+                     _mm256_castsi256_si128(packed));
+  } else {
+    _mm256_storeu_si256(static_cast<__m256i *>(ptr), v);
+  }
+}
+
+// Gather kernels: `cells` is the resolved table, padded so that a 32-bit
+// load at the last cell stays in bounds. Only the low StateWidth bytes of
+// each gathered lane are kept.
+template <std::size_t StateWidth, std::size_t EventWidth, int EventSize>
+__attribute__((target("avx2"))) inline std::size_t
+gatherStepAvx2(void *states, const void *events, std::size_t count,
+               const void *cells) noexcept {
+  auto *s = static_cast<unsigned char *>(states);
+  const auto *e = static_cast<const unsigned char *>(events);
+  const auto *base = static_cast<const int *>(cells);
+  const __m256i stride = _mm256_set1_epi32(EventSize);
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256i idx = _mm256_add_epi32(
+        _mm256_mullo_epi32(load8x32<StateWidth>(s + (i * StateWidth)),
+                           stride),
+        load8x32<EventWidth>(e + (i * EventWidth)));
+    const __m256i next =
+        _mm256_i32gather_epi32(base, idx, static_cast<int>(StateWidth));
+    store8x32<StateWidth>(s + (i * StateWidth), next);
+  }
+  return i;
+}
+
+template <std::size_t Width>
+__attribute__((target("avx512f"))) inline __m512i
+load16x32(const void *ptr) noexcept {
+  if constexpr (Width == 1) {
+    return _mm512_cvtepu8_epi32(
+        _mm_loadu_si128(static_cast<const __m128i *>(ptr)));
+  } else if constexpr (Width == 2) {
+    return _mm512_cvtepu16_epi32(
+        _mm256_loadu_si256(static_cast<const __m256i *>(ptr)));
+  } else {
+    return _mm512_loadu_si512(ptr);
+  }
+}
+
+template <std::size_t Width>
+__attribute__((target("avx512f"))) inline void store16x32(void *ptr,
+                                                          __m512i v) noexcept {
+  if constexpr (Width == 1) {
+    _mm_storeu_si128(static_cast<__m128i *>(ptr), _mm512_cvtepi32_epi8(v));
+  } else if constexpr (Width == 2) {
+    _mm256_storeu_si256(static_cast<__m256i *>(ptr), _mm512_cvtepi32_epi16(v));
+  } else {
+    _mm512_storeu_si512(ptr, v);
+  }
+}
+
+template <std::size_t StateWidth, std::size_t EventWidth, int EventSize>
+__attribute__((target("avx512f"))) inline std::size_t
+gatherStepAvx512(void *states, const void *events, std::size_t count,
+                 const void *cells) noexcept {
+  auto *s = static_cast<unsigned char *>(states);
+  const auto *e = static_cast<const unsigned char *>(events);
+  const __m512i stride = _mm512_set1_epi32(EventSize);
+  std::size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const __m512i idx = _mm512_add_epi32(
+        _mm512_mullo_epi32(load16x32<StateWidth>(s + (i * StateWidth)),
+                           stride),
+        load16x32<EventWidth>(e + (i * EventWidth)));
+    const __m512i next =
+        _mm512_i32gather_epi32(idx, cells, static_cast<int>(StateWidth));
+    store16x32<StateWidth>(s + (i * StateWidth), next);
+  }
+  return i;
+}
+
+#endif // STATE_MACHINE_X86_KERNELS
+
+} // namespace detail
+} // namespace state_machine
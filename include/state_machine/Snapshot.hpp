@@ -0,0 +1,381 @@
+#pragma once
+
+#include "EnumUtils.hpp"
+#include "TransitionTable.hpp"
+#include "Types.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <span>
+#include <utility>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+#define STATE_MACHINE_SNAPSHOT_MMAP 1
+#else
+#define STATE_MACHINE_SNAPSHOT_MMAP 0
+#endif
+
+namespace state_machine {
+
+enum class SnapshotErr {
+  Truncated,
+  BadMagic,
+  UnsupportedVersion,
+  // Written on a machine with the other byte order.
+  ByteOrderMismatch,
+  // Table instead of states (or vice versa), or different state/event
+  // counts, cell width or encoding than the type it is loaded as.
+  LayoutMismatch,
+  TagMismatch,
+  // The payload is not suitably aligned for in-place access.
+  Misaligned,
+  ChecksumMismatch,
+  // A table cell names neither a state nor the no-transition sentinel, or
+  // a stored machine state is not a state.
+  ValueOutOfRange,
+};
+
+namespace detail {
+
+enum class SnapshotKind : std::uint8_t {
+  Table = 1,
+  States = 2,
+};
+
+struct SnapshotHeader {
+  std::array<char, 4> magic;
+  std::uint16_t version;
+  SnapshotKind kind;
+  std::uint8_t encoding;
+  std::uint32_t byteOrder;
+  std::uint32_t stateCount;
+  std::uint32_t eventCount;
+  std::uint32_t cellSize;
+  std::uint64_t tag;
+  std::uint64_t count;
+  std::uint64_t payloadBytes;
+  std::uint64_t checksum;
+  std::array<std::uint8_t, 8> reserved;
+};
+static_assert(sizeof(SnapshotHeader) == 64);
+
+inline constexpr std::array<char, 4> SnapshotMagic{'S', 'M', 'S', 'N'};
+inline constexpr std::uint16_t SnapshotVersion = 1;
+inline constexpr std::uint32_t SnapshotByteOrder = 0x01020304;
+
+// FNV-1a; only computed when writing and by verifySnapshot().
+inline std::uint64_t snapshotChecksum(std::span<const std::byte> bytes) {
+  std::uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const auto b : bytes) {
+    hash = (hash ^ std::to_integer<std::uint64_t>(b)) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// Checks every stored value against the header's state count: table cells
+// may also hold the sentinel (stateCount), machine states may not.
+inline std::expected<void, SnapshotErr>
+checkSnapshotValues(const SnapshotHeader &header,
+                    std::span<const std::byte> payload) {
+  const std::uint64_t limit = header.kind == SnapshotKind::Table
+                                  ? std::uint64_t{header.stateCount}
+                                  : std::uint64_t{header.stateCount} - 1;
+  if (header.kind == SnapshotKind::Table &&
+      header.encoding == static_cast<std::uint8_t>(TableEncoding::Nibble)) {
+    for (const auto b : payload) {
+      const auto byte = std::to_integer<std::uint64_t>(b);
+      if ((byte & 0xF) > limit || (byte >> 4) > limit) {
+        return std::unexpected(SnapshotErr::ValueOutOfRange);
+      }
+    }
+    return {};
+  }
+  const std::size_t width = header.cellSize;
+  if (width != 1 && width != 2 && width != 4 && width != 8) {
+    return std::unexpected(SnapshotErr::LayoutMismatch);
+  }
+  for (std::size_t offset = 0; offset + width <= payload.size();
+       offset += width) {
+    std::uint64_t value = 0;
+    if constexpr (std::endian::native == std::endian::little) {
+      std::memcpy(&value, payload.data() + offset, width);
+    } else {
+      std::memcpy(reinterpret_cast<std::byte *>(&value) + (8 - width),
+                  payload.data() + offset, width);
+    }
+    if (value > limit) {
+      return std::unexpected(SnapshotErr::ValueOutOfRange);
+    }
+  }
+  return {};
+}
+
+inline std::vector<std::byte> writeSnapshot(SnapshotHeader header,
+                                            std::span<const std::byte> data) {
+  header.magic = SnapshotMagic;
+  header.version = SnapshotVersion;
+  header.byteOrder = SnapshotByteOrder;
+  header.payloadBytes = data.size();
+  header.checksum = snapshotChecksum(data);
+  header.reserved = {};
+  std::vector<std::byte> out(sizeof(SnapshotHeader) + data.size());
+  std::memcpy(out.data(), &header, sizeof(header));
+  if (!data.empty()) {
+    std::memcpy(out.data() + sizeof(header), data.data(), data.size());
+  }
+  return out;
+}
+
+inline std::expected<SnapshotHeader, SnapshotErr>
+readSnapshotHeader(std::span<const std::byte> bytes) {
+  SnapshotHeader header{};
+  if (bytes.size() < sizeof(header)) {
+    return std::unexpected(SnapshotErr::Truncated);
+  }
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  if (header.magic != SnapshotMagic) {
+    return std::unexpected(SnapshotErr::BadMagic);
+  }
+  if (header.version != SnapshotVersion) {
+    return std::unexpected(SnapshotErr::UnsupportedVersion);
+  }
+  if (header.byteOrder != SnapshotByteOrder) {
+    return std::unexpected(SnapshotErr::ByteOrderMismatch);
+  }
+  if (header.payloadBytes > bytes.size() - sizeof(header)) {
+    return std::unexpected(SnapshotErr::Truncated);
+  }
+  return header;
+}
+
+// Header checks shared by the loaders; returns the payload.
+template <typename Value>
+std::expected<const Value *, SnapshotErr>
+openPayload(std::span<const std::byte> bytes, SnapshotKind kind,
+            SnapshotHeader expected) {
+  const auto header = readSnapshotHeader(bytes);
+  if (!header) {
+    return std::unexpected(header.error());
+  }
+  if (header->kind != kind || header->stateCount != expected.stateCount ||
+      header->eventCount != expected.eventCount ||
+      header->cellSize != expected.cellSize ||
+      header->encoding != expected.encoding ||
+      header->payloadBytes != header->count * sizeof(Value)) {
+    return std::unexpected(SnapshotErr::LayoutMismatch);
+  }
+  if (header->tag != expected.tag) {
+    return std::unexpected(SnapshotErr::TagMismatch);
+  }
+  const std::byte *payload = bytes.data() + sizeof(SnapshotHeader);
+  if (reinterpret_cast<std::uintptr_t>(payload) % alignof(Value) != 0) {
+    return std::unexpected(SnapshotErr::Misaligned);
+  }
+  return reinterpret_cast<const Value *>(payload);
+}
+
+} // namespace detail
+
+// Binary snapshots of transition tables and machine states, loadable in
+// place from a memory mapping.
+//
+//   auto blob = snapshotTable(table, SchemaTag);      // store it anywhere
+//   ...
+//   auto file = MappedSnapshot::open("table.snap");   // next start-up
+//   auto view = loadTable<State, Event>(file->bytes(), SchemaTag);
+//   view->lookup(State::Idle, Event::Start);           // reads the mapping
+//
+// A snapshot is a 64-byte header followed by the raw cells (or states)
+// exactly as they are laid out in memory, so loading checks the header (and
+// a table's cell range) but parses and copies nothing. In exchange the
+// format is in host byte order and layout; a snapshot from a machine of
+// the other endianness is rejected, not converted. `tag` is an
+// application-chosen schema version, e.g. a hash of the enum definitions,
+// checked on load so stale snapshots are not misread.
+//
+// Guards and callbacks are code and are not part of a snapshot; attach them
+// again after loading.
+template <StateID S, EventID E, TableEncoding Encoding>
+std::vector<std::byte>
+snapshotTable(const TransitionTable<S, E, Encoding> &table,
+              std::uint64_t tag = 0) {
+  using Table = TransitionTable<S, E, Encoding>;
+  detail::SnapshotHeader header{};
+  header.kind = detail::SnapshotKind::Table;
+  header.encoding = static_cast<std::uint8_t>(Encoding);
+  header.stateCount = static_cast<std::uint32_t>(Table::StateSize);
+  header.eventCount = static_cast<std::uint32_t>(Table::EventSize);
+  header.cellSize = sizeof(typename Table::Cell);
+  header.tag = tag;
+  header.count = table.cells.size();
+  return detail::writeSnapshot(header, std::as_bytes(std::span(table.cells)));
+}
+
+// Zero-copy: the view reads `bytes` in place and must not outlive it. The
+// cells are range-checked once, so lookups through the view always yield a
+// state or S::MAX_VALUE.
+template <StateID S, EventID E,
+          TableEncoding Encoding = TableEncoding::Narrow>
+std::expected<TransitionTableView<S, E, Encoding>, SnapshotErr>
+loadTable(std::span<const std::byte> bytes, std::uint64_t tag = 0) {
+  using View = TransitionTableView<S, E, Encoding>;
+  using Value = typename View::StorageValue;
+  detail::SnapshotHeader expected{};
+  expected.encoding = static_cast<std::uint8_t>(Encoding);
+  expected.stateCount =
+      static_cast<std::uint32_t>(enum_utils::enum_size_v<S>);
+  expected.eventCount =
+      static_cast<std::uint32_t>(enum_utils::enum_size_v<E>);
+  expected.cellSize = sizeof(typename View::Cell);
+  expected.tag = tag;
+  const auto payload = detail::openPayload<Value>(
+      bytes, detail::SnapshotKind::Table, expected);
+  if (!payload) {
+    return std::unexpected(payload.error());
+  }
+  if (detail::readSnapshotHeader(bytes)->count != View::StorageSize) {
+    return std::unexpected(SnapshotErr::LayoutMismatch);
+  }
+  const View view(
+      std::span<const Value, View::StorageSize>(*payload, View::StorageSize));
+  for (std::size_t s = 0; s < enum_utils::enum_size_v<S>; ++s) {
+    for (std::size_t e = 0; e < enum_utils::enum_size_v<E>; ++e) {
+      const auto next = view.lookup(static_cast<S>(s), static_cast<E>(e));
+      if (static_cast<std::size_t>(next) > enum_utils::enum_size_v<S>) {
+        return std::unexpected(SnapshotErr::ValueOutOfRange);
+      }
+    }
+  }
+  return view;
+}
+
+// States of many machines, e.g. FSMPool::states() or a column of
+// FSMInstance states.
+template <StateID S>
+std::vector<std::byte> snapshotStates(std::span<const S> states,
+                                      std::uint64_t tag = 0) {
+  detail::SnapshotHeader header{};
+  header.kind = detail::SnapshotKind::States;
+  header.stateCount = static_cast<std::uint32_t>(enum_utils::enum_size_v<S>);
+  header.cellSize = sizeof(S);
+  header.tag = tag;
+  header.count = states.size();
+  return detail::writeSnapshot(header, std::as_bytes(states));
+}
+
+// Zero-copy: the span points into `bytes`. Values are not range-checked;
+// run verifySnapshot() first if the storage may be corrupt.
+template <StateID S>
+std::expected<std::span<const S>, SnapshotErr>
+loadStates(std::span<const std::byte> bytes, std::uint64_t tag = 0) {
+  detail::SnapshotHeader expected{};
+  expected.stateCount =
+      static_cast<std::uint32_t>(enum_utils::enum_size_v<S>);
+  expected.cellSize = sizeof(S);
+  expected.tag = tag;
+  const auto payload =
+      detail::openPayload<S>(bytes, detail::SnapshotKind::States, expected);
+  if (!payload) {
+    return std::unexpected(payload.error());
+  }
+  return std::span<const S>(
+      *payload,
+      static_cast<std::size_t>(detail::readSnapshotHeader(bytes)->count));
+}
+
+// Full integrity check: header, a checksum over the payload and the range
+// of every stored value. Linear in the snapshot size.
+inline std::expected<void, SnapshotErr>
+verifySnapshot(std::span<const std::byte> bytes) {
+  const auto header = detail::readSnapshotHeader(bytes);
+  if (!header) {
+    return std::unexpected(header.error());
+  }
+  const auto payload =
+      bytes.subspan(sizeof(detail::SnapshotHeader),
+                    static_cast<std::size_t>(header->payloadBytes));
+  if (detail::snapshotChecksum(payload) != header->checksum) {
+    return std::unexpected(SnapshotErr::ChecksumMismatch);
+  }
+  return detail::checkSnapshotValues(*header, payload);
+}
+
+#if STATE_MACHINE_SNAPSHOT_MMAP
+// Read-only private mapping of a snapshot file (POSIX). Page alignment
+// keeps every payload suitably aligned for the loaders.
+class MappedSnapshot {
+ public:
+  static std::expected<MappedSnapshot, std::error_code>
+  open(const char *path) {
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return std::unexpected(std::error_code(errno, std::system_category()));
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+      const auto err = std::error_code(errno, std::system_category());
+      ::close(fd);
+      return std::unexpected(err);
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void *data = nullptr;
+    if (size != 0) {
+      data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        const auto err = std::error_code(errno, std::system_category());
+        ::close(fd);
+        return std::unexpected(err);
+      }
+    }
+    ::close(fd);
+    return MappedSnapshot(static_cast<const std::byte *>(data), size);
+  }
+
+  MappedSnapshot(MappedSnapshot &&other) noexcept
+      : data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)) {}
+
+  MappedSnapshot &operator=(MappedSnapshot &&other) noexcept {
+    if (this != &other) {
+      unmap();
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+  }
+
+  MappedSnapshot(const MappedSnapshot &) = delete;
+  MappedSnapshot &operator=(const MappedSnapshot &) = delete;
+
+  ~MappedSnapshot() { unmap(); }
+
+  std::span<const std::byte> bytes() const noexcept { return {data_, size_}; }
+
+ private:
+  MappedSnapshot(const std::byte *data, std::size_t size) noexcept
+      : data_(data), size_(size) {}
+
+  void unmap() noexcept {
+    if (data_ != nullptr) {
+      ::munmap(const_cast<std::byte *>(data_), size_);
+    }
+  }
+
+  const std::byte *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+#endif
+
+} // namespace state_machine
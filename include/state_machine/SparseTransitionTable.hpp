@@ -0,0 +1,119 @@
+#pragma once
+
+#include "EnumUtils.hpp"
+#include "Types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace state_machine {
+
+// Transition table for large, mostly empty state/event spaces. Only defined
+// transitions are stored, as event-sorted rows in one buffer (CSR layout), so
+// memory grows with the number of transitions rather than with
+// StateSize * EventSize. Lookup is a binary search within the source state's
+// row.
+//
+// Drop-in replacement for TransitionTable as the Table parameter of
+// MachineDefinition / FSM / FSMInstance.
+template <StateID S, EventID E> class SparseTransitionTable {
+ public:
+  using State = S;
+  using Event = E;
+
+  static constexpr auto StateSize = enum_utils::enum_size_v<S>;
+  static constexpr auto EventSize = enum_utils::enum_size_v<E>;
+
+  SparseTransitionTable &enable(S from, S to, E onEvent) {
+    const auto [first, last] = row(from);
+    const auto it = findInRow(first, last, onEvent);
+    if (it != last && it->event == eventCell(onEvent)) {
+      it->next = stateCell(to);
+      return *this;
+    }
+    entries_.insert(it, Entry{eventCell(onEvent), stateCell(to)});
+    shiftRows(from, 1);
+    return *this;
+  }
+
+  SparseTransitionTable &disable(S from, E onEvent) {
+    const auto [first, last] = row(from);
+    const auto it = findInRow(first, last, onEvent);
+    if (it != last && it->event == eventCell(onEvent)) {
+      entries_.erase(it);
+      shiftRows(from, -1);
+    }
+    return *this;
+  }
+
+  void clear() noexcept {
+    entries_.clear();
+    rowOffsets_.fill(0);
+  }
+
+  S lookup(S state, E event) const noexcept {
+    const auto index = static_cast<std::size_t>(state);
+    const auto first = entries_.begin() + rowOffsets_[index];
+    const auto last = entries_.begin() + rowOffsets_[index + 1];
+    const auto it = findInRow(first, last, event);
+    if (it != last && it->event == eventCell(event)) {
+      return static_cast<S>(it->next);
+    }
+    return S::MAX_VALUE;
+  }
+
+  // Number of defined transitions.
+  std::size_t size() const noexcept { return entries_.size(); }
+
+  bool operator==(const SparseTransitionTable &) const = default;
+
+ private:
+  using StateCell = enum_utils::enum_index_t<S>;
+  using EventCell = enum_utils::enum_index_t<E>;
+
+  struct Entry {
+    EventCell event;
+    StateCell next;
+
+    bool operator==(const Entry &) const = default;
+  };
+
+  static constexpr StateCell stateCell(S state) noexcept {
+    return static_cast<StateCell>(state);
+  }
+
+  static constexpr EventCell eventCell(E event) noexcept {
+    return static_cast<EventCell>(event);
+  }
+
+  template <typename It>
+  static It findInRow(It first, It last, E event) noexcept {
+    return std::lower_bound(first, last, eventCell(event),
+                            [](const Entry &entry, EventCell value) {
+                              return entry.event < value;
+                            });
+  }
+
+  auto row(S state) {
+    const auto index = static_cast<std::size_t>(state);
+    return std::pair{entries_.begin() + rowOffsets_[index],
+                     entries_.begin() + rowOffsets_[index + 1]};
+  }
+
+  void shiftRows(S state, int delta) noexcept {
+    for (auto i = static_cast<std::size_t>(state) + 1; i < rowOffsets_.size();
+         ++i) {
+      rowOffsets_[i] = static_cast<std::uint32_t>(rowOffsets_[i] + delta);
+    }
+  }
+
+  std::vector<Entry> entries_{};
+  // Row i owns entries_[rowOffsets_[i], rowOffsets_[i + 1]).
+  std::array<std::uint32_t, StateSize + 1> rowOffsets_{};
+};
+
+} // namespace state_machine
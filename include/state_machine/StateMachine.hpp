@@ -1,175 +1,406 @@
 #pragma once
 
+#include "EdgeTransitionTable.hpp"
 #include "EnumUtils.hpp"
-#include <algorithm>
+#include "Instrumentation.hpp"
+#include "MachineDefinition.hpp"
+#include "TransitionTable.hpp"
+#include "Types.hpp"
+
 #include <array>
+#include <chrono>
 #include <concepts>
 #include <cstddef>
 #include <expected>
-#include <functional>
+#include <iterator>
+#include <memory_resource>
+#include <span>
 #include <type_traits>
 #include <utility>
-#include <vector>
 
 namespace state_machine {
 
-template <typename T>
-concept StateID = std::is_enum_v<T> &&
-                  std::is_integral_v<std::underlying_type_t<T>> && requires {
-                    { std::to_underlying(T::MAX_VALUE) } -> std::integral;
-                  };
+// `Instrumentation` is an optional policy observing every transition and
+// rejection (see Instrumentation.hpp); the default NoInstrumentation adds no
+// code and no storage.
+//
+// FSM is a regular value: copies are independent machines and moves are
+// noexcept and leave guards and callbacks in place on the heap, so machines
+// can be kept and reordered in std::vector and other containers.
+//
+// Guards and callbacks can be placed in a std::pmr::memory_resource, e.g. a
+// per-request arena released in one go (see MachineDefinition). Such a
+// machine must not outlive its resource; copies of it use the default
+// resource.
+template <StateID S, EventID E, typename Table = TransitionTable<S, E>,
+          typename Instrumentation = NoInstrumentation>
+class FSM {
+ public:
+  using State = S;
+  using Event = E;
 
-template <typename T>
-concept EventID = StateID<T>;
+  // Events a callback may raise before the current transition completes.
+  static constexpr std::size_t DeferredCapacity = 16;
 
-enum class TransitionType {
-  Enter,
-  Exit,
-};
+  FSM(S initial, Instrumentation instrumentation = {},
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : currentState_(initial), definition_(resource),
+        instrumentation_(std::move(instrumentation)) {}
 
-template <StateID State, EventID Event>
-using TransitionCallbackFn =
-    std::function<void(TransitionType, State, State, Event)>;
+  FSM(S initial, std::pmr::memory_resource *resource)
+    requires std::default_initializable<Instrumentation>
+      : FSM(initial, Instrumentation{}, resource) {}
 
-template <StateID State, EventID Event>
-using TransitionGuard = std::function<bool(State, State, Event)>;
-
-enum class ProcessEventErr {
-  TransitionForbidden,
-  NoNextStateFound,
-};
+  void init() { definition_.init(); }
 
-template <StateID S, EventID E> class FSM {
- public:
-  FSM(S initial) : currentState_(initial) {}
+  // Resets guards and callbacks like init(), then loads a prebuilt table.
+  void init(const Table &table) { definition_.init(table); }
 
-  void init() {
-    std::ranges::fill(transitionStorage_, S::MAX_VALUE);
-    for (auto &guard : transitionGuards_) {
-      guard = {};
-    }
-    for (auto &callbacks : transitionCallbacks_) {
-      callbacks.clear();
-    }
+  template <TransitionCallable<S, E> F>
+  void attachOnEnterStateCallback(S state, F &&callback) {
+    definition_.attachOnEnterStateCallback(state, std::forward<F>(callback));
   }
 
   void attachOnEnterStateCallback(S state,
                                   TransitionCallbackFn<S, E> callback) {
-    attachTransitionCallback(TransitionType::Enter, state, std::move(callback));
+    definition_.attachOnEnterStateCallback(state, std::move(callback));
+  }
+
+  template <TransitionCallable<S, E> F>
+  void attachOnExitStateCallback(S state, F &&callback) {
+    definition_.attachOnExitStateCallback(state, std::forward<F>(callback));
   }
 
   void attachOnExitStateCallback(S state, TransitionCallbackFn<S, E> callback) {
-    attachTransitionCallback(TransitionType::Exit, state, std::move(callback));
+    definition_.attachOnExitStateCallback(state, std::move(callback));
   }
 
   void enableTransition(S from, S to, E onEvent) {
-    transitionSpan_(stateIndex(from), eventIndex(onEvent)) = to;
+    definition_.enableTransition(from, to, onEvent);
+  }
+
+  void disableTransition(S from, S to, E onEvent) {
+    definition_.disableTransition(from, to, onEvent);
+  }
+
+  // Per-edge hooks, for EdgeTableBackend tables (see MachineDefinition).
+  void enableTransition(S from, S to, E onEvent, EdgeHookId guard,
+                        EdgeHookId action = NoEdgeHook)
+    requires EdgeTableBackend<Table>
+  {
+    definition_.enableTransition(from, to, onEvent, guard, action);
+  }
+
+  template <typename F>
+    requires EdgeTableBackend<Table> && TransitionGuardCallable<F, S, E>
+  EdgeHookId addEdgeGuard(F &&guard) {
+    return definition_.addEdgeGuard(std::forward<F>(guard));
+  }
+
+  EdgeHookId addEdgeGuard(TransitionGuard<S, E> guard)
+    requires EdgeTableBackend<Table>
+  {
+    return definition_.addEdgeGuard(std::move(guard));
+  }
+
+  template <typename F>
+    requires EdgeTableBackend<Table> && TransitionActionCallable<F, S, E>
+  EdgeHookId addEdgeAction(F &&action) {
+    return definition_.addEdgeAction(std::forward<F>(action));
+  }
+
+  EdgeHookId addEdgeAction(TransitionAction<S, E> action)
+    requires EdgeTableBackend<Table>
+  {
+    return definition_.addEdgeAction(std::move(action));
+  }
+
+  template <TransitionGuardCallable<S, E> F>
+  void attachTransitionGuard(S state, F &&guard,
+                             GuardPurity purity = GuardPurity::Impure) {
+    definition_.attachTransitionGuard(state, std::forward<F>(guard), purity);
   }
 
-  void disableTransition(S from, S /*to*/, E onEvent) {
-    transitionSpan_(stateIndex(from), eventIndex(onEvent)) = S::MAX_VALUE;
+  void attachTransitionGuard(S state, TransitionGuard<S, E> guard,
+                             GuardPurity purity = GuardPurity::Impure) {
+    definition_.attachTransitionGuard(state, std::move(guard), purity);
   }
 
-  void attachTransitionGuard(S state, TransitionGuard<S, E> guard) {
-    transitionGuards_[stateIndex(state)] = std::move(guard);
+  // Drops cached results of pure guards (see GuardPurity).
+  void invalidateGuards() noexcept { definition_.invalidateGuards(); }
+
+  std::pmr::memory_resource *resource() const noexcept {
+    return definition_.resource();
   }
 
+  // Run-to-completion: an event raised from a callback or guard of this
+  // machine is not processed on the spot. It is queued (up to
+  // DeferredCapacity, no allocation), reported as ProcessEventErr::Deferred,
+  // and processed once the current transition has finished. Deferred events
+  // run in order, iteratively; their own results are discarded.
   std::expected<S, ProcessEventErr> processEvent(E event) {
-    const auto nextState = computeTransition(currentState_, event);
-    if (nextState == S::MAX_VALUE) {
-      return std::unexpected(ProcessEventErr::NoNextStateFound);
+    if (dispatch_.active) {
+      return defer(event);
     }
+    DispatchScope scope(*this);
+    auto result = step(event);
+    drainDeferred();
+    return result;
+  }
 
-    auto &guard = transitionGuards_[stateIndex(currentState_)];
-    if (guard) {
-      bool result = std::invoke(guard, currentState_, nextState, event);
-      if (!result) {
-        return std::unexpected(ProcessEventErr::TransitionForbidden);
-      }
+  // Events cascaded from each batch event are drained before the next one;
+  // called from a callback, the whole span is deferred instead.
+  BatchResult
+  processEvents(std::span<const E> events,
+                BatchErrorPolicy policy = BatchErrorPolicy::StopOnError) {
+    if (!Instrumented && !definition_.hasHooks()) {
+      return definition_.processEvents(currentState_, events, policy);
     }
+    return runBatch(events, policy, static_cast<NoOutput *>(nullptr));
+  }
 
-    for (const auto &cb : transitionCallbacks_[callbackIndex(
-             TransitionType::Exit, currentState_)]) {
-      if (cb) {
-        std::invoke(cb, TransitionType::Exit, currentState_, nextState, event);
-      }
+  // As above, writing the state after each event and its cascade.
+  template <std::output_iterator<S> Out>
+  BatchResult
+  processEvents(std::span<const E> events, Out out,
+                BatchErrorPolicy policy = BatchErrorPolicy::StopOnError) {
+    if (!Instrumented && !definition_.hasHooks()) {
+      return definition_.processEvents(currentState_, events, std::move(out),
+                                       policy);
     }
+    return runBatch(events, policy, &out);
+  }
 
-    const S prevState = currentState_;
-    currentState_ = nextState;
+  // Minimizes the definition from the current state (see
+  // MachineDefinition::minimize()) and renumbers the current state.
+  StateMap<S> minimize(std::span<const S> keep = {}) {
+    const auto states = definition_.minimize(currentState_, keep);
+    currentState_ = states(currentState_);
+    return states;
+  }
 
-    for (const auto &cb : transitionCallbacks_[callbackIndex(
-             TransitionType::Enter, nextState)]) {
-      if (cb) {
-        std::invoke(cb, TransitionType::Enter, prevState, nextState, event);
-      }
-    }
+  S getCurrentState() const { return currentState_; }
 
-    return nextState;
+  const MachineDefinition<S, E, Table> &definition() const noexcept {
+    return definition_;
   }
 
-  S getCurrentState() const { return currentState_; }
+  Instrumentation &instrumentation() noexcept { return instrumentation_; }
+  const Instrumentation &instrumentation() const noexcept {
+    return instrumentation_;
+  }
 
  private:
-  static constexpr size_t stateIndex(S state) noexcept {
-    return static_cast<size_t>(state);
-  }
+  static constexpr bool Instrumented = is_instrumented_v<Instrumentation, S, E>;
+
+  // Marks the machine as dispatching; drops queued events if a callback
+  // throws.
+  struct DispatchScope {
+    explicit DispatchScope(FSM &fsm) noexcept : fsm(fsm) {
+      fsm.dispatch_.active = true;
+    }
+    ~DispatchScope() {
+      fsm.dispatch_.active = false;
+      fsm.dispatch_.count = 0;
+    }
+    FSM &fsm;
+  };
+
+  // State of the processEvent() call in progress. It belongs to the object,
+  // not its value: a machine copied or moved from inside one of its own
+  // callbacks starts idle with an empty queue, and assignment leaves the
+  // target's in-flight dispatch alone. Everything else is copied or moved
+  // member-wise; moves take over the callback storage without copying it.
+  struct Dispatch {
+    Dispatch() = default;
+    Dispatch(const Dispatch &) noexcept {}
+    Dispatch &operator=(const Dispatch &) noexcept { return *this; }
+
+    bool active = false;
+    std::size_t head = 0;
+    std::size_t count = 0;
+    std::array<E, DeferredCapacity> events{};
+  };
+
+  struct NoOutput {};
+
+  // Output iterator handed to MachineDefinition's batch loop: drains the
+  // deferred queue after each event, then forwards the state to `out`.
+  template <typename Out> struct DrainingOut {
+    using difference_type = std::ptrdiff_t;
+
+    DrainingOut &operator*() noexcept { return *this; }
+    DrainingOut &operator++() noexcept { return *this; }
+    DrainingOut &operator++(int) noexcept { return *this; }
+    DrainingOut &operator=(S) {
+      fsm->drainDeferred();
+      if constexpr (!std::is_same_v<Out, NoOutput>) {
+        *(*out)++ = fsm->currentState_;
+      }
+      return *this;
+    }
 
-  static constexpr size_t eventIndex(E event) noexcept {
-    return static_cast<size_t>(event);
+    FSM *fsm;
+    Out *out;
+  };
+
+  std::expected<S, ProcessEventErr> defer(E event) {
+    if (dispatch_.count == DeferredCapacity) {
+      return reject(currentState_, event, ProcessEventErr::DeferredQueueFull);
+    }
+    const auto tail = (dispatch_.head + dispatch_.count) % DeferredCapacity;
+    dispatch_.events[tail] = event;
+    ++dispatch_.count;
+    return std::unexpected(ProcessEventErr::Deferred);
   }
 
-  static constexpr size_t typeIndex(TransitionType type) noexcept {
-    switch (type) {
-    case TransitionType::Enter:
-      return 0;
-    case TransitionType::Exit:
-      return 1;
+  void drainDeferred() {
+    while (dispatch_.count != 0) {
+      const E event = dispatch_.events[dispatch_.head];
+      dispatch_.head = (dispatch_.head + 1) % DeferredCapacity;
+      --dispatch_.count;
+      (void)step(event);
     }
-    return 0;
   }
 
-  static constexpr size_t callbackIndex(TransitionType type, S state) noexcept {
-    return (typeIndex(type) * StateSize) + stateIndex(state);
+  std::unexpected<ProcessEventErr> reject(S from, E event,
+                                          ProcessEventErr err) {
+    if constexpr (CountsRejections<Instrumentation, S, E>) {
+      instrumentation_.onRejected(from, event, err);
+    }
+    return std::unexpected(err);
   }
 
-  S computeTransition(S state, E event) {
-    return transitionSpan_(stateIndex(state), eventIndex(event));
+  // One transition. Uninstrumented, this is exactly
+  // MachineDefinition::processEvent(); otherwise the same steps with the
+  // policy called around them.
+  std::expected<S, ProcessEventErr> step(E event) {
+    if constexpr (!Instrumented) {
+      return definition_.processEvent(currentState_, event);
+    } else {
+      const S from = currentState_;
+      const auto edge = definition_.computeEdge(from, event);
+      const S next = edge.next;
+      if (next == S::MAX_VALUE) {
+        return reject(from, event, ProcessEventErr::NoNextStateFound);
+      }
+      if (!definition_.allowsTransition(from, edge, event)) {
+        return reject(from, event, ProcessEventErr::TransitionForbidden);
+      }
+
+      constexpr bool Timed = TimesCallbacks<Instrumentation, S, E>;
+      std::chrono::steady_clock::time_point start{};
+      if constexpr (Timed) {
+        start = std::chrono::steady_clock::now();
+      }
+      definition_.notifyExit(from, next, event);
+      definition_.runAction(from, edge, event);
+      currentState_ = next;
+      definition_.notifyEnter(from, next, event);
+      if constexpr (Timed) {
+        instrumentation_.onCallbacks(
+            from, next, event,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start));
+      }
+      if constexpr (CountsTransitions<Instrumentation, S, E>) {
+        instrumentation_.onTransition(from, next, event);
+      }
+      return next;
+    }
   }
 
-  void attachTransitionCallback(TransitionType type, S state,
-                                TransitionCallbackFn<S, E> callback) {
-    transitionCallbacks_[callbackIndex(type, state)].push_back(
-        std::move(callback));
+  template <typename Out>
+  BatchResult runBatch(std::span<const E> events, BatchErrorPolicy policy,
+                       Out *out) {
+    if (dispatch_.active) {
+      BatchResult result{};
+      for (const E event : events) {
+        ++result.consumed;
+        if (defer(event).error() == ProcessEventErr::Deferred) {
+          continue;
+        }
+        ++result.failed;
+        result.firstError = ProcessEventErr::DeferredQueueFull;
+        if (policy == BatchErrorPolicy::StopOnError) {
+          break;
+        }
+      }
+      return result;
+    }
+    DispatchScope scope(*this);
+    if constexpr (!Instrumented) {
+      return definition_.processEvents(currentState_, events,
+                                       DrainingOut<Out>{this, out}, policy);
+    } else {
+      BatchResult result{};
+      for (const E event : events) {
+        ++result.consumed;
+        const auto r = step(event);
+        drainDeferred();
+        if constexpr (!std::is_same_v<Out, NoOutput>) {
+          *(*out)++ = currentState_;
+        }
+        if (!r) {
+          ++result.failed;
+          if (!result.firstError) {
+            result.firstError = r.error();
+          }
+          if (policy == BatchErrorPolicy::StopOnError) {
+            break;
+          }
+        }
+      }
+      return result;
+    }
   }
 
- private:
   S currentState_{};
+  MachineDefinition<S, E, Table> definition_{};
+  Dispatch dispatch_{};
+  [[no_unique_address]] Instrumentation instrumentation_;
+};
 
-  static constexpr auto StateSize = enum_utils::enum_size_v<S>;
-  static constexpr auto EventSize = enum_utils::enum_size_v<E>;
-  static constexpr auto CallbackSlotCount = 2 * StateSize;
+// A machine that borrows a shared MachineDefinition and only owns its current
+// state. Use it when many machines share one topology, e.g. one per
+// connection; the definition must outlive every instance.
+template <StateID S, EventID E, typename Table = TransitionTable<S, E>>
+class FSMInstance {
+ public:
+  using State = S;
+  using Event = E;
 
-  struct TransitionTableView {
-    S *data{};
+  FSMInstance(const MachineDefinition<S, E, Table> &definition,
+              S initial) noexcept
+      : definition_(&definition), currentState_(initial) {}
 
-    constexpr S &operator()(size_t stateIdx, size_t eventIdx) noexcept {
-      return data[(stateIdx * EventSize) + eventIdx];
-    }
+  std::expected<S, ProcessEventErr> processEvent(E event) {
+    return definition_->processEvent(currentState_, event);
+  }
 
-    constexpr const S &operator()(size_t stateIdx,
-                                  size_t eventIdx) const noexcept {
-      return data[(stateIdx * EventSize) + eventIdx];
-    }
-  };
+  BatchResult
+  processEvents(std::span<const E> events,
+                BatchErrorPolicy policy = BatchErrorPolicy::StopOnError) {
+    return definition_->processEvents(currentState_, events, policy);
+  }
 
-  std::array<S, StateSize * EventSize> transitionStorage_{};
-  TransitionTableView transitionSpan_{transitionStorage_.data()};
+  template <std::output_iterator<S> Out>
+  BatchResult
+  processEvents(std::span<const E> events, Out out,
+                BatchErrorPolicy policy = BatchErrorPolicy::StopOnError) {
+    return definition_->processEvents(currentState_, events, std::move(out),
+                                      policy);
+  }
+
+  S getCurrentState() const noexcept { return currentState_; }
 
-  using TransitionCallbackVector = std::vector<TransitionCallbackFn<S, E>>;
-  std::array<TransitionCallbackVector, CallbackSlotCount> transitionCallbacks_{};
+  const MachineDefinition<S, E, Table> &definition() const noexcept {
+    return *definition_;
+  }
 
-  std::array<TransitionGuard<S, E>, StateSize> transitionGuards_{};
+ private:
+  const MachineDefinition<S, E, Table> *definition_;
+  S currentState_;
 };
 
 } // namespace state_machine
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Hooks.hpp"
+#include "TransitionTable.hpp"
+#include "Types.hpp"
+
+#include <expected>
+#include <utility>
+
+namespace state_machine {
+
+// FSM whose topology is fixed at compile time. The table is a template
+// parameter object, so every instance only stores its current state and
+// processEvent() reduces to a load from a constant table.
+//
+// Guards and callbacks come from an optional hooks policy (see Hooks.hpp),
+// called directly rather than through std::function.
+template <auto Table, typename Hooks = NoHooks>
+  requires is_transition_table_v<decltype(Table)>
+class StaticFSM {
+ public:
+  using State = typename decltype(Table)::State;
+  using Event = typename decltype(Table)::Event;
+
+  constexpr StaticFSM(State initial, Hooks hooks = {})
+      : currentState_(initial), hooks_(std::move(hooks)) {}
+
+  constexpr std::expected<State, ProcessEventErr> processEvent(Event event) {
+    return detail::processWithHooks(Table, currentState_, event, hooks_);
+  }
+
+  constexpr State getCurrentState() const noexcept { return currentState_; }
+
+  constexpr Hooks &hooks() noexcept { return hooks_; }
+  constexpr const Hooks &hooks() const noexcept { return hooks_; }
+
+  static constexpr const auto &table() noexcept { return Table; }
+
+ private:
+  State currentState_{};
+  [[no_unique_address]] Hooks hooks_;
+};
+
+} // namespace state_machine
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Hooks.hpp"
+#include "TransitionTable.hpp"
+#include "Types.hpp"
+
+#include <array>
+#include <cstddef>
+#include <expected>
+#include <utility>
+
+namespace state_machine {
+
+namespace detail {
+// Holds a SwitchFSM's handler array outside the class, so it is built when
+// processEvent() is instantiated and the machine type is complete.
+template <typename Machine> struct SwitchHandlers {
+  static constexpr auto value = Machine::makeHandlers(
+      std::make_index_sequence<Machine::StateSize * Machine::EventSize>{});
+};
+} // namespace detail
+
+// StaticFSM with the table compiled into code instead of read from memory.
+// Every enabled cell gets its own handler, generated by std::index_sequence
+// expansion over the constant table, and processEvent() is one indirect
+// jump through the array of handlers (a computed goto). A handler stores a
+// constant next state and calls the hooks with constant states and event,
+// so they inline and fold per transition; empty cells share one handler
+// returning NoNextStateFound.
+//
+// The jump target depends on the event, so this wins when the event stream
+// is predictable (protocol sequences, polling loops): the branch predictor
+// runs ahead of the state dependency that bounds StaticFSM. On random
+// streams the mispredicted jump costs several times StaticFSM's table
+// load; measure both (see the process_event/static and /switch rows in
+// fsm_bench). Code size grows with the enabled cells, hence the cap.
+template <auto Table, typename Hooks = NoHooks>
+  requires is_transition_table_v<decltype(Table)>
+class SwitchFSM {
+ public:
+  using State = typename decltype(Table)::State;
+  using Event = typename decltype(Table)::Event;
+
+  static constexpr std::size_t MaxCells = 4096;
+  static_assert(decltype(Table)::CellCount <= MaxCells,
+                "SwitchFSM generates a handler per cell; use StaticFSM for "
+                "large tables");
+
+  constexpr SwitchFSM(State initial, Hooks hooks = {})
+      : currentState_(initial), hooks_(std::move(hooks)) {}
+
+  constexpr std::expected<State, ProcessEventErr> processEvent(Event event) {
+    const auto &handlers = detail::SwitchHandlers<SwitchFSM>::value;
+    return handlers[Table.cellIndex(currentState_, event)](*this);
+  }
+
+  constexpr State getCurrentState() const noexcept { return currentState_; }
+
+  constexpr Hooks &hooks() noexcept { return hooks_; }
+  constexpr const Hooks &hooks() const noexcept { return hooks_; }
+
+  static constexpr const auto &table() noexcept { return Table; }
+
+ private:
+  friend struct detail::SwitchHandlers<SwitchFSM>;
+
+  using Result = std::expected<State, ProcessEventErr>;
+
+  static constexpr std::size_t StateSize = decltype(Table)::StateSize;
+  static constexpr std::size_t EventSize = decltype(Table)::EventSize;
+
+  using Handler = Result (*)(SwitchFSM &);
+
+  template <std::size_t C> static consteval Handler handler() noexcept {
+    constexpr auto from = static_cast<State>(C / EventSize);
+    constexpr auto event = static_cast<Event>(C % EventSize);
+    if constexpr (Table.lookup(from, event) == State::MAX_VALUE) {
+      return &SwitchFSM::noTransition;
+    } else {
+      return &SwitchFSM::transition<from, event>;
+    }
+  }
+
+  template <std::size_t... Cs>
+  static constexpr std::array<Handler, sizeof...(Cs)>
+  makeHandlers(std::index_sequence<Cs...>) noexcept {
+    return {handler<Cs>()...};
+  }
+
+  static constexpr Result noTransition(SwitchFSM &) {
+    return std::unexpected(ProcessEventErr::NoNextStateFound);
+  }
+
+  // Same steps as detail::processWithHooks(), with every value constant.
+  template <State From, Event On>
+  static constexpr Result transition(SwitchFSM &self) {
+    constexpr State to = Table.lookup(From, On);
+    if constexpr (HasGuardHook<Hooks, State, Event>) {
+      if (!self.hooks_.guard(From, to, On)) {
+        return std::unexpected(ProcessEventErr::TransitionForbidden);
+      }
+    }
+    if constexpr (HasExitHook<Hooks, State, Event>) {
+      self.hooks_.onExit(From, to, On);
+    }
+    self.currentState_ = to;
+    if constexpr (HasEnterHook<Hooks, State, Event>) {
+      self.hooks_.onEnter(From, to, On);
+    }
+    return to;
+  }
+
+  State currentState_{};
+  [[no_unique_address]] Hooks hooks_;
+};
+
+} // namespace state_machine
@@ -0,0 +1,383 @@
+#pragma once
+
+#include "EnumUtils.hpp"
+#include "Types.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <utility>
+
+namespace state_machine {
+
+class TimerWheel;
+
+// A timer that can be armed in a TimerWheel. When it expires the wheel
+// unlinks it and calls `callback(node, context)`, which may re-arm it. A
+// node in a wheel must not be destroyed or moved by another thread while
+// the wheel runs; moving it on the wheel's thread takes over its place, so
+// nodes can live in containers that reallocate.
+class TimerNode {
+ public:
+  using Callback = void (*)(TimerNode &node, void *context);
+
+  TimerNode() noexcept = default;
+
+  TimerNode(Callback callback, void *context) noexcept
+      : callback_(callback), context_(context) {}
+
+  TimerNode(TimerNode &&other) noexcept
+      : deadline_(other.deadline_), callback_(other.callback_),
+        context_(other.context_) {
+    takePlace(other);
+  }
+
+  TimerNode &operator=(TimerNode &&other) noexcept {
+    if (this != &other) {
+      cancel();
+      deadline_ = other.deadline_;
+      callback_ = other.callback_;
+      context_ = other.context_;
+      takePlace(other);
+    }
+    return *this;
+  }
+
+  TimerNode(const TimerNode &) = delete;
+  TimerNode &operator=(const TimerNode &) = delete;
+
+  ~TimerNode() { cancel(); }
+
+  bool armed() const noexcept { return wheel_ != nullptr; }
+
+  // Tick the timer fires at; meaningful while armed().
+  std::uint64_t deadline() const noexcept { return deadline_; }
+
+  void setContext(void *context) noexcept { context_ = context; }
+
+  inline void cancel() noexcept;
+
+ private:
+  friend class TimerWheel;
+
+  void unlink() noexcept {
+    prev_->next_ = next_;
+    next_->prev_ = prev_;
+    prev_ = next_ = this;
+  }
+
+  void takePlace(TimerNode &other) noexcept {
+    wheel_ = std::exchange(other.wheel_, nullptr);
+    if (wheel_ != nullptr) {
+      prev_ = other.prev_;
+      next_ = other.next_;
+      prev_->next_ = this;
+      next_->prev_ = this;
+      other.prev_ = other.next_ = &other;
+    }
+  }
+
+  TimerNode *prev_ = this;
+  TimerNode *next_ = this;
+  std::uint64_t deadline_ = 0;
+  Callback callback_ = nullptr;
+  void *context_ = nullptr;
+  TimerWheel *wheel_ = nullptr;
+};
+
+// Hierarchical timing wheel: Levels rings of 64 slots, each level 64 times
+// coarser than the one below, covering 2^24 ticks; later deadlines wait in
+// an overflow list. A timer sits in the level of the highest 6-bit group
+// where its deadline differs from the current tick and is moved down when
+// that group is reached, so every timer fires exactly at its deadline
+// after at most Levels moves. Arming and cancelling are a list splice.
+//
+// advance() fires each tick's timers as one batch: the slot is detached
+// first, so callbacks may arm, re-arm or cancel any timer. Time is an
+// abstract tick count chosen by the caller; the wheel is single-threaded.
+class TimerWheel {
+ public:
+  static constexpr std::size_t Levels = 4;
+  static constexpr std::size_t SlotBits = 6;
+  static constexpr std::size_t Slots = std::size_t{1} << SlotBits;
+
+  explicit TimerWheel(std::uint64_t now = 0) noexcept : now_(now) {}
+
+  TimerWheel(const TimerWheel &) = delete;
+  TimerWheel &operator=(const TimerWheel &) = delete;
+
+  ~TimerWheel() {
+    for (auto &slot : slots_) {
+      release(slot);
+    }
+    release(overflow_);
+  }
+
+  std::uint64_t now() const noexcept { return now_; }
+
+  // Armed timers.
+  std::size_t size() const noexcept { return size_; }
+
+  // Arms (or re-arms) `node` to fire at tick `deadline`; deadlines not after
+  // now() fire on the next advance().
+  void arm(TimerNode &node, std::uint64_t deadline) noexcept {
+    node.cancel();
+    node.deadline_ = deadline > now_ ? deadline : now_ + 1;
+    node.wheel_ = this;
+    ++size_;
+    insert(node);
+  }
+
+  void armAfter(TimerNode &node, std::uint64_t ticks) noexcept {
+    arm(node, now_ + (ticks == 0 ? 1 : ticks));
+  }
+
+  // Moves time forward to `now`, firing every timer due on the way in
+  // deadline order (timers due on the same tick in arming order). Returns
+  // the number fired.
+  std::size_t advance(std::uint64_t now) {
+    std::size_t fired = 0;
+    while (now_ < now) {
+      if (size_ == 0) {
+        now_ = now;
+        break;
+      }
+      ++now_;
+      cascade();
+      fired += fire(slots_[now_ & (Slots - 1)]);
+    }
+    return fired;
+  }
+
+ private:
+  friend class TimerNode;
+
+  static constexpr std::size_t Horizon = Levels * SlotBits;
+
+  void insert(TimerNode &node) noexcept {
+    const auto diff = node.deadline_ ^ now_;
+    TimerNode *head = &overflow_;
+    for (std::size_t level = 0; level < Levels; ++level) {
+      if ((diff >> ((level + 1) * SlotBits)) == 0) {
+        const auto slot =
+            (node.deadline_ >> (level * SlotBits)) & (Slots - 1);
+        head = &slots_[(level * Slots) + slot];
+        break;
+      }
+    }
+    node.prev_ = head->prev_;
+    node.next_ = head;
+    head->prev_->next_ = &node;
+    head->prev_ = &node;
+  }
+
+  // At each level boundary the slot now reached is redistributed, from the
+  // coarsest level reached down, so its timers land in finer slots.
+  void cascade() noexcept {
+    if ((now_ & ((std::uint64_t{1} << Horizon) - 1)) == 0) {
+      reinsert(overflow_);
+    }
+    for (auto level = Levels - 1; level > 0; --level) {
+      const auto shift = level * SlotBits;
+      if ((now_ & ((std::uint64_t{1} << shift) - 1)) == 0) {
+        reinsert(slots_[(level * Slots) + ((now_ >> shift) & (Slots - 1))]);
+      }
+    }
+  }
+
+  void reinsert(TimerNode &head) noexcept {
+    TimerNode pending;
+    splice(head, pending);
+    while (pending.next_ != &pending) {
+      TimerNode &node = *pending.next_;
+      node.unlink();
+      insert(node);
+    }
+  }
+
+  std::size_t fire(TimerNode &head) {
+    if (head.next_ == &head) {
+      return 0;
+    }
+    TimerNode batch;
+    splice(head, batch);
+    std::size_t fired = 0;
+    while (batch.next_ != &batch) {
+      TimerNode &node = *batch.next_;
+      node.unlink();
+      node.wheel_ = nullptr;
+      --size_;
+      ++fired;
+      if (node.callback_ != nullptr) {
+        node.callback_(node, node.context_);
+      }
+    }
+    return fired;
+  }
+
+  // Moves the whole list at `from` to the empty list `to`.
+  static void splice(TimerNode &from, TimerNode &to) noexcept {
+    if (from.next_ == &from) {
+      return;
+    }
+    to.next_ = from.next_;
+    to.prev_ = from.prev_;
+    to.next_->prev_ = &to;
+    to.prev_->next_ = &to;
+    from.next_ = from.prev_ = &from;
+  }
+
+  void release(TimerNode &head) noexcept {
+    while (head.next_ != &head) {
+      TimerNode &node = *head.next_;
+      node.unlink();
+      node.wheel_ = nullptr;
+    }
+  }
+
+  std::uint64_t now_;
+  std::size_t size_ = 0;
+  // List heads (sentinels).
+  std::array<TimerNode, Levels * Slots> slots_{};
+  TimerNode overflow_{};
+};
+
+inline void TimerNode::cancel() noexcept {
+  if (wheel_ != nullptr) {
+    unlink();
+    --wheel_->size_;
+    wheel_ = nullptr;
+  }
+}
+
+// Per-state timeouts: "after `ticks` in `state`, raise `event`".
+template <StateID S, EventID E> class StateTimeouts {
+ public:
+  constexpr StateTimeouts() noexcept { events_.fill(E::MAX_VALUE); }
+
+  constexpr StateTimeouts &after(S state, std::uint64_t ticks,
+                                 E event) noexcept {
+    ticks_[index(state)] = ticks;
+    events_[index(state)] = event;
+    return *this;
+  }
+
+  constexpr StateTimeouts &clear(S state) noexcept {
+    events_[index(state)] = E::MAX_VALUE;
+    return *this;
+  }
+
+  constexpr bool has(S state) const noexcept {
+    return events_[index(state)] != E::MAX_VALUE;
+  }
+
+  constexpr std::uint64_t ticks(S state) const noexcept {
+    return ticks_[index(state)];
+  }
+
+  // E::MAX_VALUE if `state` has no timeout.
+  constexpr E event(S state) const noexcept { return events_[index(state)]; }
+
+ private:
+  static constexpr std::size_t index(S state) noexcept {
+    return static_cast<std::size_t>(state);
+  }
+
+  std::array<std::uint64_t, enum_utils::enum_size_v<S>> ticks_{};
+  std::array<E, enum_utils::enum_size_v<S>> events_{};
+};
+
+// Wraps a machine (FSM, FSMInstance, ...) with the timeouts of its states,
+// so many machines can share one TimerWheel. Entering a state, including by
+// a self-transition, re-arms the machine's timer for that state; leaving it
+// before the deadline cancels it. When the timer fires, the state's event is
+// processed like any other event. The timer is an intrusive node inside the
+// wrapper, so arming, re-arming and cancelling never allocate and are O(1).
+//
+//   TimerWheel wheel;                          // ticks in any unit, e.g. ms
+//   const auto timeouts = StateTimeouts<State, Event>{}.after(
+//       State::Active, 30'000, Event::Timeout);
+//   std::vector<TimedFSM<FSMInstance<State, Event>>> machines;
+//   machines.emplace_back(FSMInstance(definition, State::Idle), wheel,
+//                         timeouts);
+//   ...
+//   wheel.advance(nowInTicks);                 // fires due timeouts
+//
+// The wheel and the timeouts must outlive the machine; moving the machine
+// (e.g. in a reallocating vector) keeps its timer armed. Timeout events are
+// processed inside advance(), on the wheel's thread, which must also be the
+// thread calling processEvent().
+template <typename Machine> class TimedFSM {
+ public:
+  using State = typename Machine::State;
+  using Event = typename Machine::Event;
+
+  TimedFSM(Machine machine, TimerWheel &wheel,
+           const StateTimeouts<State, Event> &timeouts)
+      : machine_(std::move(machine)), wheel_(&wheel), timeouts_(&timeouts),
+        timer_(&TimedFSM::expired, this) {
+    rearm();
+  }
+
+  TimedFSM(TimedFSM &&other) noexcept
+      : machine_(std::move(other.machine_)), wheel_(other.wheel_),
+        timeouts_(other.timeouts_), timer_(std::move(other.timer_)) {
+    timer_.setContext(this);
+  }
+
+  TimedFSM &operator=(TimedFSM &&other) noexcept {
+    if (this != &other) {
+      machine_ = std::move(other.machine_);
+      wheel_ = other.wheel_;
+      timeouts_ = other.timeouts_;
+      timer_ = std::move(other.timer_);
+      timer_.setContext(this);
+    }
+    return *this;
+  }
+
+  std::expected<State, ProcessEventErr> processEvent(Event event) {
+    const State before = machine_.getCurrentState();
+    auto result = machine_.processEvent(event);
+    if (result || machine_.getCurrentState() != before) {
+      rearm();
+    }
+    return result;
+  }
+
+  State getCurrentState() const { return machine_.getCurrentState(); }
+
+  Machine &machine() noexcept { return machine_; }
+  const Machine &machine() const noexcept { return machine_; }
+
+  const TimerNode &timer() const noexcept { return timer_; }
+
+ private:
+  void rearm() noexcept {
+    const State state = machine_.getCurrentState();
+    if (timeouts_->has(state)) {
+      wheel_->armAfter(timer_, timeouts_->ticks(state));
+    } else {
+      timer_.cancel();
+    }
+  }
+
+  // A timeout that finds no transition is dropped; the machine stays put
+  // without a timer until it next changes state.
+  static void expired(TimerNode &, void *context) {
+    auto &self = *static_cast<TimedFSM *>(context);
+    const Event event =
+        self.timeouts_->event(self.machine_.getCurrentState());
+    if (event != Event::MAX_VALUE) {
+      (void)self.processEvent(event);
+    }
+  }
+
+  Machine machine_;
+  TimerWheel *wheel_;
+  const StateTimeouts<State, Event> *timeouts_;
+  TimerNode timer_;
+};
+
+} // namespace state_machine
@@ -0,0 +1,285 @@
+#pragma once
+
+#include "EnumUtils.hpp"
+#include "Types.hpp"
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+    (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#define STATE_MACHINE_TRACE_TSC 1
+#else
+#define STATE_MACHINE_TRACE_TSC 0
+#endif
+
+namespace state_machine {
+
+// Unit of TraceEntry::timestamp.
+enum class TraceClock : std::uint8_t {
+  // std::chrono::steady_clock nanoseconds.
+  SteadyNanoseconds,
+  // Raw x86 time-stamp counter ticks (invariant TSC on modern CPUs).
+  Tsc,
+  // No clock: the timestamp is the record's sequence number. Ordering only,
+  // for the cheapest recording.
+  Sequence,
+};
+
+// Tsc where available, else SteadyNanoseconds.
+inline constexpr TraceClock DefaultTraceClock =
+    STATE_MACHINE_TRACE_TSC ? TraceClock::Tsc : TraceClock::SteadyNanoseconds;
+
+enum class TraceDecodeErr {
+  Truncated,
+  BadMagic,
+  UnsupportedVersion,
+  StateOutOfRange,
+};
+
+template <StateID S, EventID E> struct TraceEntry {
+  std::uint64_t timestamp;
+  S from;
+  // Equal to `from` for rejected events.
+  S to;
+  E event;
+  std::optional<ProcessEventErr> error;
+};
+
+template <StateID S, EventID E> struct DecodedTrace {
+  TraceClock clock;
+  // Records ever written; more than entries.size() if the ring wrapped.
+  std::uint64_t recorded;
+  std::vector<TraceEntry<S, E>> entries;
+};
+
+namespace detail {
+
+inline constexpr std::array<std::byte, 4> TraceMagic{
+    std::byte{'S'}, std::byte{'M'}, std::byte{'T'}, std::byte{'R'}};
+inline constexpr std::uint16_t TraceVersion = 1;
+inline constexpr std::size_t TraceHeaderSize = 32;
+inline constexpr std::size_t TraceRecordSize = 16;
+
+template <TraceClock Clock>
+inline std::uint64_t traceTimestamp(std::uint64_t sequence) noexcept {
+  if constexpr (Clock == TraceClock::Sequence) {
+    return sequence;
+  } else if constexpr (Clock == TraceClock::Tsc) {
+#if STATE_MACHINE_TRACE_TSC
+    return __rdtsc();
+#endif
+  } else {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+  }
+}
+
+template <typename T> void putLE(std::byte *out, T value) noexcept {
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    out[i] =
+        static_cast<std::byte>(static_cast<std::uint64_t>(value) >> (8 * i));
+  }
+}
+
+template <typename T> T getLE(const std::byte *in) noexcept {
+  std::uint64_t value = 0;
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    value |= std::to_integer<std::uint64_t>(in[i]) << (8 * i);
+  }
+  return static_cast<T>(value);
+}
+
+} // namespace detail
+
+// Binary transition trace for post-mortem analysis.
+//
+// TraceBuffer keeps the last Capacity transitions and rejections of a
+// machine as 16-byte records; TraceInstrumentation plugs it into FSM:
+//
+//   TraceBuffer<S, E, 1024> trace;
+//   FSM<S, E, TransitionTable<S, E>, TraceInstrumentation<S, E, 1024>>
+//       fsm(S::Idle, TraceInstrumentation(trace));
+//   ...
+//   std::vector<std::byte> blob = trace.dump();   // write it anywhere
+//   auto decoded = decodeTrace<S, E>(blob);       // later, elsewhere
+//
+// Dump format, little-endian:
+//   header (32 bytes): "SMTR", u16 version (1), u16 record size (16),
+//                      u8 clock (TraceClock), 7 reserved bytes,
+//                      u64 record count, u64 total recorded
+//   records, oldest first: u64 timestamp, u16 from, u16 to, u16 event,
+//                          u8 result (0 = ok, else ProcessEventErr + 1),
+//                          1 reserved byte
+//
+// Fixed-size ring of the most recent records; older ones are overwritten.
+// Recording is a timestamp read and one 16-byte store, with no locks,
+// atomics or allocation; the clock read dominates, so Sequence is the
+// choice when only the order matters. Like FSM itself, a buffer has one
+// writer: give each machine (or thread) its own, and dump it from that
+// thread or after it has stopped.
+template <StateID S, EventID E, std::size_t Capacity = 1024,
+          TraceClock Clock = DefaultTraceClock>
+  requires(std::has_single_bit(Capacity) &&
+           (Clock != TraceClock::Tsc || STATE_MACHINE_TRACE_TSC != 0))
+class TraceBuffer {
+  static_assert(enum_utils::enum_size_v<S> <= 0xFFFF &&
+                    enum_utils::enum_size_v<E> <= 0xFFFF,
+                "Trace records store states and events in 16 bits");
+
+ public:
+  static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+  void record(S from, S to, E event,
+              std::optional<ProcessEventErr> error = std::nullopt) noexcept {
+    records_[head_ & (Capacity - 1)] = {
+        detail::traceTimestamp<Clock>(head_),
+        static_cast<std::uint16_t>(from),
+        static_cast<std::uint16_t>(to),
+        static_cast<std::uint16_t>(event),
+        static_cast<std::uint8_t>(error ? static_cast<int>(*error) + 1 : 0),
+        0};
+    ++head_;
+  }
+
+  // Records ever written, including overwritten ones.
+  std::uint64_t recorded() const noexcept { return head_; }
+
+  std::size_t size() const noexcept {
+    return head_ < Capacity ? static_cast<std::size_t>(head_) : Capacity;
+  }
+
+  void clear() noexcept { head_ = 0; }
+
+  // Retained records, oldest first, in the dump format described above
+  // TraceBuffer.
+  std::vector<std::byte> dump() const {
+    const auto count = size();
+    std::vector<std::byte> out(detail::TraceHeaderSize +
+                               (count * detail::TraceRecordSize));
+    std::byte *p = out.data();
+    for (std::size_t i = 0; i < detail::TraceMagic.size(); ++i) {
+      p[i] = detail::TraceMagic[i];
+    }
+    detail::putLE<std::uint16_t>(p + 4, detail::TraceVersion);
+    detail::putLE<std::uint16_t>(p + 6, detail::TraceRecordSize);
+    detail::putLE(p + 8, static_cast<std::uint8_t>(Clock));
+    detail::putLE<std::uint64_t>(p + 16, count);
+    detail::putLE<std::uint64_t>(p + 24, head_);
+    p += detail::TraceHeaderSize;
+
+    for (std::uint64_t i = head_ - count; i < head_; ++i) {
+      const Record &r = records_[i & (Capacity - 1)];
+      detail::putLE(p, r.timestamp);
+      detail::putLE(p + 8, r.from);
+      detail::putLE(p + 10, r.to);
+      detail::putLE(p + 12, r.event);
+      detail::putLE(p + 14, r.result);
+      p += detail::TraceRecordSize;
+    }
+    return out;
+  }
+
+ private:
+  struct Record {
+    std::uint64_t timestamp;
+    std::uint16_t from;
+    std::uint16_t to;
+    std::uint16_t event;
+    std::uint8_t result;
+    std::uint8_t reserved;
+  };
+  static_assert(sizeof(Record) == detail::TraceRecordSize);
+
+  std::array<Record, Capacity> records_{};
+  std::uint64_t head_ = 0;
+};
+
+// Parses a TraceBuffer::dump(). Records naming states or events outside
+// S and E (e.g. a dump from another machine) are reported as
+// StateOutOfRange rather than cast.
+template <StateID S, EventID E>
+std::expected<DecodedTrace<S, E>, TraceDecodeErr>
+decodeTrace(std::span<const std::byte> bytes) {
+  if (bytes.size() < detail::TraceHeaderSize) {
+    return std::unexpected(TraceDecodeErr::Truncated);
+  }
+  const std::byte *p = bytes.data();
+  for (std::size_t i = 0; i < detail::TraceMagic.size(); ++i) {
+    if (p[i] != detail::TraceMagic[i]) {
+      return std::unexpected(TraceDecodeErr::BadMagic);
+    }
+  }
+  if (detail::getLE<std::uint16_t>(p + 4) != detail::TraceVersion ||
+      detail::getLE<std::uint16_t>(p + 6) != detail::TraceRecordSize ||
+      detail::getLE<std::uint8_t>(p + 8) >
+          static_cast<std::uint8_t>(TraceClock::Sequence)) {
+    return std::unexpected(TraceDecodeErr::UnsupportedVersion);
+  }
+  const auto count = detail::getLE<std::uint64_t>(p + 16);
+  if (count > (bytes.size() - detail::TraceHeaderSize) /
+                  detail::TraceRecordSize) {
+    return std::unexpected(TraceDecodeErr::Truncated);
+  }
+
+  DecodedTrace<S, E> trace{
+      static_cast<TraceClock>(detail::getLE<std::uint8_t>(p + 8)),
+      detail::getLE<std::uint64_t>(p + 24), {}};
+  trace.entries.reserve(static_cast<std::size_t>(count));
+  p += detail::TraceHeaderSize;
+  for (std::uint64_t i = 0; i < count; ++i, p += detail::TraceRecordSize) {
+    const auto from = detail::getLE<std::uint16_t>(p + 8);
+    const auto to = detail::getLE<std::uint16_t>(p + 10);
+    const auto event = detail::getLE<std::uint16_t>(p + 12);
+    const auto result = detail::getLE<std::uint8_t>(p + 14);
+    if (from >= enum_utils::enum_size_v<S> ||
+        to >= enum_utils::enum_size_v<S> ||
+        event >= enum_utils::enum_size_v<E> ||
+        result > enum_utils::enum_size_v<ProcessEventErr>) {
+      return std::unexpected(TraceDecodeErr::StateOutOfRange);
+    }
+    trace.entries.push_back(
+        {detail::getLE<std::uint64_t>(p), static_cast<S>(from),
+         static_cast<S>(to), static_cast<E>(event),
+         result == 0
+             ? std::nullopt
+             : std::optional(static_cast<ProcessEventErr>(result - 1))});
+  }
+  return trace;
+}
+
+// Instrumentation policy (see Instrumentation.hpp) recording every
+// transition and rejection into a TraceBuffer that outlives the machine.
+template <StateID S, EventID E, std::size_t Capacity = 1024,
+          TraceClock Clock = DefaultTraceClock>
+class TraceInstrumentation {
+  using Buffer = TraceBuffer<S, E, Capacity, Clock>;
+
+ public:
+  explicit TraceInstrumentation(Buffer &buffer) noexcept : buffer_(&buffer) {}
+
+  void onTransition(S from, S to, E event) noexcept {
+    buffer_->record(from, to, event);
+  }
+
+  void onRejected(S from, E event, ProcessEventErr err) noexcept {
+    buffer_->record(from, from, event, err);
+  }
+
+  Buffer &buffer() const noexcept { return *buffer_; }
+
+ private:
+  Buffer *buffer_;
+};
+
+} // namespace state_machine
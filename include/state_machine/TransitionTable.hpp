@@ -0,0 +1,191 @@
+#pragma once
+
+#include "EnumUtils.hpp"
+#include "Types.hpp"
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace state_machine {
+
+// How TransitionTable packs its cells. Cells store the target state's index,
+// with StateSize (the value of S::MAX_VALUE) as the "no transition" sentinel.
+enum class TableEncoding {
+  // One enum_utils::enum_index_t<S> per cell: the narrowest unsigned type
+  // that fits StateSize + 1 values, independent of S's underlying type.
+  Narrow,
+  // Two cells per byte. Requires fewer than 16 states.
+  Nibble,
+};
+
+// Dense (state, event) -> next state table that can be built in a constant
+// expression. Cells without a transition hold S::MAX_VALUE.
+//
+// The type is structural, so a constexpr table can be passed to StaticFSM as
+// a non-type template parameter and lives in read-only storage:
+//
+//   constexpr auto table =
+//       TransitionTable<State, Event>{}
+//           .enable(State::Idle, State::Active, Event::Start)
+//           .enable(State::Active, State::Stopped, Event::Timeout);
+template <StateID S, EventID E,
+          TableEncoding Encoding = TableEncoding::Narrow>
+struct TransitionTable {
+  using State = S;
+  using Event = E;
+  using Cell = enum_utils::enum_index_t<S>;
+
+  static constexpr auto StateSize = enum_utils::enum_size_v<S>;
+  static constexpr auto EventSize = enum_utils::enum_size_v<E>;
+  static constexpr auto CellCount = StateSize * EventSize;
+  static constexpr auto CellEncoding = Encoding;
+
+  static_assert(Encoding != TableEncoding::Nibble || StateSize < 16,
+                "Nibble encoding needs the sentinel to fit in 4 bits");
+
+  using Storage =
+      std::conditional_t<Encoding == TableEncoding::Nibble,
+                         std::array<std::uint8_t, (CellCount + 1) / 2>,
+                         std::array<Cell, CellCount>>;
+
+  // Public only so the type stays structural; use the member functions.
+  Storage cells = emptyCells();
+
+  constexpr TransitionTable &enable(S from, S to, E onEvent) noexcept {
+    store(cellIndex(from, onEvent), static_cast<Cell>(to));
+    return *this;
+  }
+
+  constexpr TransitionTable &disable(S from, E onEvent) noexcept {
+    store(cellIndex(from, onEvent), SentinelCell);
+    return *this;
+  }
+
+  constexpr void clear() noexcept { cells = emptyCells(); }
+
+  constexpr S lookup(S state, E event) const noexcept {
+    return static_cast<S>(load(cells.data(), cellIndex(state, event)));
+  }
+
+  friend constexpr bool operator==(const TransitionTable &,
+                                   const TransitionTable &) = default;
+
+  static constexpr std::size_t cellIndex(S state, E event) noexcept {
+    return (static_cast<std::size_t>(state) * EventSize) +
+           static_cast<std::size_t>(event);
+  }
+
+ private:
+  template <StateID, EventID, TableEncoding> friend class TransitionTableView;
+
+  static constexpr Cell SentinelCell = static_cast<Cell>(StateSize);
+
+  static constexpr Cell load(const typename Storage::value_type *storage,
+                             std::size_t index) noexcept {
+    if constexpr (Encoding == TableEncoding::Nibble) {
+      return static_cast<Cell>((storage[index / 2] >> ((index % 2) * 4)) &
+                               0xF);
+    } else {
+      return storage[index];
+    }
+  }
+
+  constexpr void store(std::size_t index, Cell value) noexcept {
+    if constexpr (Encoding == TableEncoding::Nibble) {
+      const auto shift = (index % 2) * 4;
+      auto &byte = cells[index / 2];
+      byte = static_cast<std::uint8_t>((byte & ~(0xF << shift)) |
+                                       (value << shift));
+    } else {
+      cells[index] = value;
+    }
+  }
+
+  static constexpr Storage emptyCells() noexcept {
+    Storage empty{};
+    if constexpr (Encoding == TableEncoding::Nibble) {
+      for (auto &byte : empty) {
+        byte = static_cast<std::uint8_t>((SentinelCell << 4) | SentinelCell);
+      }
+    } else {
+      for (auto &cell : empty) {
+        cell = SentinelCell;
+      }
+    }
+    return empty;
+  }
+};
+
+// Read-only view of a TransitionTable's cells held elsewhere, e.g. in a
+// memory-mapped snapshot (see Snapshot.hpp). Lookups read the storage in
+// place; the view must not outlive it.
+template <StateID S, EventID E,
+          TableEncoding Encoding = TableEncoding::Narrow>
+class TransitionTableView {
+  using Owner = TransitionTable<S, E, Encoding>;
+
+ public:
+  using State = S;
+  using Event = E;
+  using Cell = typename Owner::Cell;
+  using StorageValue = typename Owner::Storage::value_type;
+
+  // Number of StorageValue elements a table's cells occupy.
+  static constexpr std::size_t StorageSize =
+      std::tuple_size_v<typename Owner::Storage>;
+
+  constexpr TransitionTableView(const Owner &table) noexcept
+      : data_(table.cells.data()) {}
+
+  // `storage` must hold StorageSize elements laid out as Owner::cells.
+  constexpr explicit TransitionTableView(
+      std::span<const StorageValue, StorageSize> storage) noexcept
+      : data_(storage.data()) {}
+
+  constexpr S lookup(S state, E event) const noexcept {
+    return static_cast<S>(Owner::load(data_, Owner::cellIndex(state, event)));
+  }
+
+  constexpr const StorageValue *data() const noexcept { return data_; }
+
+  // Owning copy, for FSM, MachineDefinition or FSMPool.
+  constexpr Owner table() const noexcept {
+    Owner owned{};
+    for (std::size_t i = 0; i < StorageSize; ++i) {
+      owned.cells[i] = data_[i];
+    }
+    return owned;
+  }
+
+ private:
+  const StorageValue *data_;
+};
+
+// Interface shared by the table backends MachineDefinition can use: this
+// dense table and SparseTransitionTable.
+template <typename T>
+concept TransitionTableBackend =
+    StateID<typename T::State> && EventID<typename T::Event> &&
+    requires(T table, const T &ctable, typename T::State state,
+             typename T::Event event) {
+      table.enable(state, state, event);
+      table.disable(state, event);
+      table.clear();
+      { ctable.lookup(state, event) } -> std::same_as<typename T::State>;
+    };
+
+template <typename T> struct is_transition_table : std::false_type {};
+
+template <StateID S, EventID E, TableEncoding Encoding>
+struct is_transition_table<TransitionTable<S, E, Encoding>> : std::true_type {
+};
+
+template <typename T>
+inline constexpr bool is_transition_table_v =
+    is_transition_table<std::remove_cvref_t<T>>::value;
+
+} // namespace state_machine
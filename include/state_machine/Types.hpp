@@ -0,0 +1,91 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace state_machine {
+
+template <typename T>
+concept StateID = std::is_enum_v<T> &&
+                  std::is_integral_v<std::underlying_type_t<T>> && requires {
+                    { std::to_underlying(T::MAX_VALUE) } -> std::integral;
+                  };
+
+template <typename T>
+concept EventID = StateID<T>;
+
+enum class TransitionType {
+  Enter,
+  Exit,
+};
+
+template <StateID State, EventID Event>
+using TransitionCallbackFn =
+    std::function<void(TransitionType, State, State, Event)>;
+
+template <StateID State, EventID Event>
+using TransitionGuard = std::function<bool(State, State, Event)>;
+
+// Per-edge action (see EdgeTransitionTable): runs between the Exit and
+// Enter callbacks of the transition it is attached to.
+template <StateID State, EventID Event>
+using TransitionAction = std::function<void(State, State, Event)>;
+
+// Callables accepted where a TransitionCallbackFn / TransitionGuard /
+// TransitionAction is stored, without first being wrapped in a std::function.
+template <typename F, typename State, typename Event>
+concept TransitionCallable =
+    std::copy_constructible<std::decay_t<F>> &&
+    std::invocable<std::decay_t<F> &, TransitionType, State, State, Event>;
+
+template <typename F, typename State, typename Event>
+concept TransitionGuardCallable =
+    std::copy_constructible<std::decay_t<F>> &&
+    std::is_invocable_r_v<bool, std::decay_t<F> &, State, State, Event>;
+
+template <typename F, typename State, typename Event>
+concept TransitionActionCallable =
+    std::copy_constructible<std::decay_t<F>> &&
+    std::invocable<std::decay_t<F> &, State, State, Event>;
+
+// How a guard's result may be reused. A Pure guard depends only on its
+// (from, to, event) arguments, or on configuration that changes rarely and
+// is followed by invalidateGuards(); its result is computed once per
+// (state, event) cell and then served from a cache.
+enum class GuardPurity {
+  Impure,
+  Pure,
+};
+
+enum class ProcessEventErr {
+  TransitionForbidden,
+  NoNextStateFound,
+  // Raised from a callback or guard: queued, runs once the current
+  // transition completes (FSM only).
+  Deferred,
+  // Raised from a callback or guard while the deferred queue was full.
+  DeferredQueueFull,
+  // Sentinel, never returned: enum_size_v<ProcessEventErr> sizes tables
+  // indexed by error kind. Keep it last.
+  MAX_VALUE,
+};
+
+// What processEvents() does when an event is rejected.
+enum class BatchErrorPolicy {
+  StopOnError,
+  ContinueOnError,
+};
+
+struct BatchResult {
+  // Events taken from the input, including rejected ones. With StopOnError
+  // the last consumed event is the one that failed.
+  std::size_t consumed{};
+  std::size_t failed{};
+  std::optional<ProcessEventErr> firstError{};
+};
+
+} // namespace state_machine
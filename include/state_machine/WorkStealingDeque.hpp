@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace state_machine {
+
+// Bounded Chase-Lev work-stealing deque of pointers (Le et al., "Correct and
+// Efficient Work-Stealing for Weak Memory Models", 2013). The owning thread
+// pushes and pops at the bottom; any other thread may steal from the top.
+template <typename T, std::size_t Capacity> class WorkStealingDeque {
+  static_assert(std::has_single_bit(Capacity),
+                "Capacity must be a power of two");
+
+ public:
+  WorkStealingDeque() = default;
+  WorkStealingDeque(const WorkStealingDeque &) = delete;
+  WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+  // Owner only. Returns false when the deque is full.
+  bool push(T *item) noexcept {
+    const auto b = bottom_.load(std::memory_order_relaxed);
+    const auto t = top_.load(std::memory_order_acquire);
+    if (b - t >= static_cast<std::int64_t>(Capacity)) {
+      return false;
+    }
+    slots_[static_cast<std::size_t>(b) & Mask].store(item,
+                                                     std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Owner only. Returns nullptr when empty.
+  T *pop() noexcept {
+    const auto b = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T *item =
+        slots_[static_cast<std::size_t>(b) & Mask].load(std::memory_order_relaxed);
+    if (t == b) {
+      // Last item: race against thieves for it.
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // Any thread. Returns nullptr when empty or when it lost a race.
+  T *steal() noexcept {
+    auto t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) {
+      return nullptr;
+    }
+    T *item =
+        slots_[static_cast<std::size_t>(t) & Mask].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  // Approximate when called by a thief.
+  bool empty() const noexcept {
+    return bottom_.load(std::memory_order_acquire) <=
+           top_.load(std::memory_order_acquire);
+  }
+
+ private:
+  static constexpr std::size_t Mask = Capacity - 1;
+  static constexpr std::size_t CacheLine = 64;
+
+  alignas(CacheLine) std::atomic<std::int64_t> top_{0};
+  alignas(CacheLine) std::atomic<std::int64_t> bottom_{0};
+  alignas(CacheLine) std::array<std::atomic<T *>, Capacity> slots_{};
+};
+
+} // namespace state_machine
@@ -0,0 +1,38 @@
+// Minimal pass/fail bookkeeping shared by the framework-free test
+// executables.
+
+#pragma once
+
+#include <print>
+#include <string_view>
+
+struct TestSuite {
+  int passed = 0;
+  int failed = 0;
+
+  void expect_true(bool cond, std::string_view msg) {
+    if (cond) {
+      ++passed;
+      std::println("[PASS] {}", msg);
+    } else {
+      ++failed;
+      std::println("[FAIL] {}", msg);
+    }
+  }
+
+  template <typename T, typename U>
+  void expect_eq(const T &lhs, const U &rhs, std::string_view msg) {
+    if (lhs == rhs) {
+      ++passed;
+      std::println("[PASS] {}", msg);
+    } else {
+      ++failed;
+      std::println("[FAIL] {}", msg);
+    }
+  }
+
+  int summary() const {
+    std::println("\nSummary: {} passed, {} failed", passed, failed);
+    return failed == 0 ? 0 : 1;
+  }
+};
@@ -0,0 +1,155 @@
+// Tests for state_machine::MpscQueue and AsyncFSM.
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <expected>
+#include <print>
+#include <thread>
+#include <vector>
+
+#include <state_machine/AsyncStateMachine.hpp>
+#include <state_machine/MpscQueue.hpp>
+#include <state_machine/StateMachine.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class TState {
+  Idle,
+  Active,
+  Stopped,
+  Canceled,
+  MAX_VALUE,
+};
+
+enum class TEvent {
+  Start,
+  Timeout,
+  Cancel,
+  Restart,
+  MAX_VALUE,
+};
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Queue is FIFO and reports full/empty
+  {
+    sm::MpscQueue<int, 4> q;
+    ts.expect_true(q.empty(), "New queue is empty");
+    bool pushed = true;
+    for (int i = 0; i < 4; ++i) {
+      pushed = pushed && q.tryPush(i);
+    }
+    ts.expect_true(pushed, "Queue accepts Capacity items");
+    ts.expect_true(!q.tryPush(4), "Full queue rejects push");
+    bool ordered = true;
+    for (int i = 0; i < 4; ++i) {
+      const auto v = q.tryPop();
+      ordered = ordered && v && *v == i;
+    }
+    ts.expect_true(ordered, "Items pop in FIFO order");
+    ts.expect_true(!q.tryPop().has_value(), "Empty queue pops nothing");
+    ts.expect_true(q.tryPush(5) && q.tryPop() == 5, "Queue wraps around");
+  }
+
+  // Test 2: Concurrent producers keep per-producer order, nothing is lost
+  {
+    constexpr int producers = 4;
+    constexpr std::uint32_t perProducer = 50000;
+    sm::MpscQueue<std::uint32_t, 1024> q;
+    std::array<std::uint32_t, producers> nextExpected{};
+    bool ordered = true;
+    std::uint32_t received = 0;
+    {
+      std::vector<std::jthread> threads;
+      for (std::uint32_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&q, p] {
+          for (std::uint32_t i = 0; i < perProducer; ++i) {
+            while (!q.tryPush((p << 24) | i)) {
+              std::this_thread::yield();
+            }
+          }
+        });
+      }
+      while (received < producers * perProducer) {
+        if (const auto v = q.tryPop()) {
+          const auto p = *v >> 24;
+          const auto i = *v & 0xFFFFFF;
+          ordered = ordered && nextExpected[p] == i;
+          nextExpected[p] = i + 1;
+          ++received;
+        }
+      }
+    }
+    ts.expect_eq(received, producers * perProducer,
+                 "Consumer received every item");
+    ts.expect_true(ordered, "Per-producer FIFO order preserved");
+  }
+
+  // Test 3: drain() runs queued events in order on the calling thread
+  {
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.init();
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    fsm.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+
+    std::vector<bool> outcomes;
+    sm::AsyncFSM<sm::FSM<TState, TEvent>, 8> async(
+        std::move(fsm), [&](TEvent, sm::AsyncFSM<sm::FSM<TState, TEvent>,
+                                                 8>::Result result) {
+          outcomes.push_back(result.has_value());
+        });
+    async.post(TEvent::Start);
+    async.post(TEvent::Cancel);
+    async.post(TEvent::Timeout);
+    ts.expect_eq(async.drain(), std::size_t{3}, "drain() processed 3 events");
+    ts.expect_true(outcomes == std::vector{true, false, true},
+                   "Completion handler sees each result in order");
+    ts.expect_eq(async.machine().getCurrentState(), TState::Stopped,
+                 "Machine reached Stopped");
+  }
+
+  // Test 4: Dispatcher thread consumes events from several producers
+  {
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.init();
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    fsm.enableTransition(TState::Active, TState::Idle, TEvent::Timeout);
+
+    using Async = sm::AsyncFSM<sm::FSM<TState, TEvent>, 256>;
+    std::atomic<int> completed{0};
+    std::atomic<int> succeeded{0};
+    Async async(std::move(fsm), [&](TEvent, Async::Result result) {
+      completed.fetch_add(1, std::memory_order_relaxed);
+      if (result) {
+        succeeded.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+    async.start();
+
+    constexpr int producers = 4;
+    constexpr int perProducer = 20000;
+    {
+      std::vector<std::jthread> threads;
+      for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&async, p] {
+          const auto event = p % 2 == 0 ? TEvent::Start : TEvent::Timeout;
+          for (int i = 0; i < perProducer; ++i) {
+            while (!async.post(event)) {
+              std::this_thread::yield();
+            }
+          }
+        });
+      }
+    }
+    async.stop();
+    ts.expect_eq(completed.load(), producers * perProducer,
+                 "Every posted event completed");
+    ts.expect_true(succeeded.load() > 0, "Some events transitioned");
+  }
+
+  return ts.summary();
+}
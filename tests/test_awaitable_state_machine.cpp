@@ -0,0 +1,177 @@
+// Tests for state_machine::AwaitableFSM (co_await on states and transitions).
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <print>
+#include <utility>
+#include <vector>
+
+#include <state_machine/AwaitableStateMachine.hpp>
+#include <state_machine/StateMachine.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class TState {
+  Idle,
+  Active,
+  Stopped,
+  Canceled,
+  MAX_VALUE,
+};
+
+enum class TEvent {
+  Start,
+  Timeout,
+  Cancel,
+  Restart,
+  MAX_VALUE,
+};
+
+using Machine = sm::FSM<TState, TEvent>;
+using Awaitable = sm::AwaitableFSM<Machine>;
+using Step = sm::Transition<TState, TEvent>;
+
+// Minimal eager coroutine: runs until its first suspension, destroyed with
+// the Task.
+struct Task {
+  struct promise_type {
+    Task get_return_object() {
+      return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+  Task(Task &&other) noexcept : handle(std::exchange(other.handle, {})) {}
+  ~Task() {
+    if (handle) {
+      handle.destroy();
+    }
+  }
+
+  bool done() const { return handle.done(); }
+
+  std::coroutine_handle<promise_type> handle;
+};
+
+static Machine makeMachine() {
+  Machine fsm(TState::Idle);
+  fsm.init();
+  fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+  fsm.enableTransition(TState::Active, TState::Active, TEvent::Restart);
+  fsm.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+  fsm.enableTransition(TState::Stopped, TState::Idle, TEvent::Restart);
+  return fsm;
+}
+
+static Task waitFor(Awaitable &fsm, TState target,
+                    std::optional<Step> &entered, std::vector<int> &log,
+                    int tag) {
+  entered = co_await fsm.until(target);
+  log.push_back(tag);
+}
+
+static Task collect(Awaitable &fsm, std::vector<Step> &out, int count) {
+  for (int i = 0; i < count; ++i) {
+    out.push_back(co_await fsm.nextTransition());
+  }
+}
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: until() on the current state completes without suspending
+  {
+    Awaitable fsm(makeMachine());
+    std::optional<Step> entered{Step{}};
+    std::vector<int> log;
+    Task t = waitFor(fsm, TState::Idle, entered, log, 1);
+    ts.expect_true(t.done(), "Already in target state: no suspension");
+    ts.expect_true(!entered.has_value(), "No entering transition reported");
+    ts.expect_true(!fsm.hasWaiters(), "No waiter registered");
+  }
+
+  // Test 2: until() resumes on entry, after Enter callbacks, not before
+  {
+    Machine machine = makeMachine();
+    std::vector<int> log;
+    machine.attachOnEnterStateCallback(
+        TState::Stopped,
+        [&](sm::TransitionType, TState, TState, TEvent) { log.push_back(0); });
+    Awaitable fsm(std::move(machine));
+    std::optional<Step> entered;
+    Task t = waitFor(fsm, TState::Stopped, entered, log, 1);
+    ts.expect_true(!t.done() && fsm.hasWaiters(), "Suspended until Stopped");
+
+    fsm.processEvent(TEvent::Start);
+    fsm.processEvent(TEvent::Restart);
+    ts.expect_true(!t.done(), "Other transitions do not resume");
+    ts.expect_true(!fsm.processEvent(TEvent::Cancel).has_value() && !t.done(),
+                   "Rejected event does not resume");
+
+    fsm.processEvent(TEvent::Timeout);
+    ts.expect_true(t.done(), "Resumed on entering Stopped");
+    ts.expect_true(entered == Step{TState::Active, TState::Stopped,
+                                   TEvent::Timeout},
+                   "until() yields the entering transition");
+    ts.expect_true(log == std::vector<int>{0, 1},
+                   "Resumed after the Enter callback");
+  }
+
+  // Test 3: nextTransition() in a loop sees each transition once
+  {
+    Awaitable fsm(makeMachine());
+    std::vector<Step> seen;
+    Task t = collect(fsm, seen, 3);
+    fsm.processEvent(TEvent::Start);
+    ts.expect_eq(seen.size(), std::size_t{1},
+                 "Re-await does not see the same transition");
+    fsm.processEvent(TEvent::Restart);
+    fsm.processEvent(TEvent::Timeout);
+    fsm.processEvent(TEvent::Restart);
+    ts.expect_true(t.done(), "Collector finished after three transitions");
+    ts.expect_true(
+        seen == std::vector<Step>{
+                    {TState::Idle, TState::Active, TEvent::Start},
+                    {TState::Active, TState::Active, TEvent::Restart},
+                    {TState::Active, TState::Stopped, TEvent::Timeout}},
+        "Transitions reported in order, self-loops included");
+  }
+
+  // Test 4: several waiters resume in registration order
+  {
+    Awaitable fsm(makeMachine());
+    std::vector<int> log;
+    std::optional<Step> a, b, c;
+    Task t1 = waitFor(fsm, TState::Active, a, log, 1);
+    Task t2 = waitFor(fsm, TState::Stopped, b, log, 2);
+    Task t3 = waitFor(fsm, TState::Active, c, log, 3);
+    fsm.processEvent(TEvent::Start);
+    ts.expect_true(log == std::vector<int>{1, 3},
+                   "Matching waiters resumed in order");
+    ts.expect_true(!t2.done() && fsm.hasWaiters(),
+                   "Non-matching waiter stays queued");
+  }
+
+  // Test 5: destroying a suspended coroutine unregisters its waiter
+  {
+    Awaitable fsm(makeMachine());
+    std::vector<int> log;
+    std::optional<Step> a, b;
+    std::optional<Task> dropped{waitFor(fsm, TState::Active, a, log, 1)};
+    Task kept = waitFor(fsm, TState::Active, b, log, 2);
+    dropped.reset();
+    fsm.processEvent(TEvent::Start);
+    ts.expect_true(log == std::vector<int>{2} && kept.done(),
+                   "Only the live waiter is resumed");
+    ts.expect_true(!fsm.hasWaiters(), "Waiter list empty afterwards");
+  }
+
+  return ts.summary();
+}
@@ -0,0 +1,194 @@
+// Tests for state_machine::ByteScanner and ByteEventMap.
+
+#include <array>
+#include <cstddef>
+#include <expected>
+#include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <state_machine/ByteScanner.hpp>
+#include <state_machine/TransitionTable.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+// Recognizes  [0-9]+ ( '.' [0-9]+ )? ';'
+enum class NumState {
+  Start,
+  Int,
+  Dot,
+  Frac,
+  Done,
+  MAX_VALUE,
+};
+
+enum class NumEvent {
+  Digit,
+  Dot,
+  Semicolon,
+  MAX_VALUE,
+};
+
+constexpr auto numberTable =
+    sm::TransitionTable<NumState, NumEvent>{}
+        .enable(NumState::Start, NumState::Int, NumEvent::Digit)
+        .enable(NumState::Int, NumState::Int, NumEvent::Digit)
+        .enable(NumState::Int, NumState::Dot, NumEvent::Dot)
+        .enable(NumState::Int, NumState::Done, NumEvent::Semicolon)
+        .enable(NumState::Dot, NumState::Frac, NumEvent::Digit)
+        .enable(NumState::Frac, NumState::Frac, NumEvent::Digit)
+        .enable(NumState::Frac, NumState::Done, NumEvent::Semicolon);
+
+constexpr auto numberEvents =
+    sm::ByteEventMap<NumEvent>{}
+        .mapRange(std::byte{'0'}, std::byte{'9'}, NumEvent::Digit)
+        .map(std::byte{'.'}, NumEvent::Dot)
+        .map(std::byte{';'}, NumEvent::Semicolon);
+
+static std::span<const std::byte> bytes(std::string_view text) {
+  return std::as_bytes(std::span(text.data(), text.size()));
+}
+
+int main() {
+  TestSuite ts{};
+  const std::array accepting{NumState::Done};
+  const sm::ByteScanner<NumState, NumEvent> scanner(numberTable, numberEvents,
+                                                    accepting);
+
+  // Test 1: Accepting state stops the scan just past the byte that entered it
+  {
+    const auto r = scanner.scan(bytes("3.14;rest"), NumState::Start);
+    ts.expect_true(r.stop == sm::ScanStop::Accepted, "Number accepted");
+    ts.expect_eq(r.position, std::size_t{5}, "Position after ';'");
+    ts.expect_eq(r.state, NumState::Done, "Final state Done");
+  }
+
+  // Test 2: Missing transition and unmapped bytes stop at the offending byte
+  {
+    const auto r = scanner.scan(bytes("12..3;"), NumState::Start);
+    ts.expect_true(r.stop == sm::ScanStop::NoTransition,
+                   "Second dot has no transition");
+    ts.expect_eq(r.position, std::size_t{3}, "Stopped at second dot");
+    ts.expect_eq(r.state, NumState::Dot, "State before the failing byte");
+
+    const auto u = scanner.scan(bytes("12x"), NumState::Start);
+    ts.expect_true(u.stop == sm::ScanStop::NoTransition && u.position == 2,
+                   "Unmapped byte stops the scan");
+  }
+
+  // Test 3: Chunked input resumes from the returned state
+  {
+    const std::string_view text = "1234567.890123;";
+    bool ok = true;
+    for (std::size_t split = 0; split <= text.size(); ++split) {
+      const auto first = scanner.scan(bytes(text.substr(0, split)),
+                                      NumState::Start);
+      if (split < text.size()) {
+        ok = ok && first.stop == sm::ScanStop::Exhausted &&
+             first.position == split;
+        const auto second =
+            scanner.scan(bytes(text.substr(split)), first.state);
+        ok = ok && second.stop == sm::ScanStop::Accepted &&
+             split + second.position == text.size();
+      } else {
+        ok = ok && first.stop == sm::ScanStop::Accepted;
+      }
+    }
+    ts.expect_true(ok, "Every chunk split gives the same result");
+    ts.expect_true(scanner.scan({}, NumState::Int).stop ==
+                       sm::ScanStop::Exhausted,
+                   "Empty chunk is Exhausted without moving");
+  }
+
+  // Test 4: Agrees with a per-byte table walk on random input
+  {
+    std::mt19937 rng(3);
+    const std::string_view alphabet = "0123456789.;x";
+    bool same = true;
+    for (int round = 0; round < 2000; ++round) {
+      std::vector<std::byte> input(rng() % 12);
+      for (auto &b : input) {
+        b = static_cast<std::byte>(alphabet[rng() % alphabet.size()]);
+      }
+      const auto r = scanner.scan(input, NumState::Start);
+
+      NumState state = NumState::Start;
+      std::size_t pos = 0;
+      sm::ScanStop stop = sm::ScanStop::Exhausted;
+      for (; pos < input.size(); ++pos) {
+        const auto ev = numberEvents.lookup(input[pos]);
+        const auto next = ev == NumEvent::MAX_VALUE
+                              ? NumState::MAX_VALUE
+                              : numberTable.lookup(state, ev);
+        if (next == NumState::MAX_VALUE) {
+          stop = sm::ScanStop::NoTransition;
+          break;
+        }
+        state = next;
+        if (state == NumState::Done) {
+          stop = sm::ScanStop::Accepted;
+          ++pos;
+          break;
+        }
+      }
+      same = same && r.stop == stop && r.position == pos && r.state == state;
+    }
+    ts.expect_true(same, "Scanner matches a per-byte table walk");
+  }
+
+  // Test 5: Interleaved scan of K streams matches K separate scans
+  {
+    std::mt19937 rng(11);
+    const std::string_view alphabet = "0123456789.;";
+    bool same = true;
+    for (int round = 0; round < 500; ++round) {
+      std::array<std::vector<std::byte>, 8> buffers;
+      std::array<std::span<const std::byte>, 8> inputs;
+      std::array<NumState, 8> states{};
+      for (std::size_t k = 0; k < 8; ++k) {
+        buffers[k].resize(rng() % 40);
+        for (auto &b : buffers[k]) {
+          b = static_cast<std::byte>(alphabet[rng() % alphabet.size()]);
+        }
+        inputs[k] = buffers[k];
+        states[k] = static_cast<NumState>(rng() % 4);
+      }
+      const auto results = scanner.scanInterleaved<8>(inputs, states);
+      for (std::size_t k = 0; k < 8; ++k) {
+        const auto r = scanner.scan(inputs[k], states[k]);
+        same = same && r.position == results[k].position &&
+               r.state == results[k].state && r.stop == results[k].stop;
+      }
+    }
+    ts.expect_true(same, "scanInterleaved<8> equals per-stream scan()");
+  }
+
+  // Test 6: Runtime stream count, processed K at a time
+  {
+    std::vector<std::string> texts;
+    for (int i = 0; i < 37; ++i) {
+      texts.push_back(std::to_string(i * 7919) + (i % 3 == 0 ? ".5;" : ";x"));
+    }
+    std::vector<std::span<const std::byte>> inputs;
+    std::vector<sm::ScanResult<NumState>> results(texts.size());
+    for (std::size_t i = 0; i < texts.size(); ++i) {
+      inputs.push_back(bytes(texts[i]));
+      results[i].state = NumState::Start;
+    }
+    scanner.scanInterleaved<4>(inputs, results);
+    bool ok = true;
+    for (std::size_t i = 0; i < texts.size(); ++i) {
+      const auto expected = texts[i].find(';') + 1;
+      ok = ok && results[i].stop == sm::ScanStop::Accepted &&
+           results[i].position == expected;
+    }
+    ts.expect_true(ok, "37 streams scanned four at a time");
+  }
+
+  return ts.summary();
+}
@@ -0,0 +1,182 @@
+// Tests for state_machine::ConcurrentFSM.
+
+#include <atomic>
+#include <expected>
+#include <print>
+#include <thread>
+#include <vector>
+
+#include <state_machine/ConcurrentStateMachine.hpp>
+#include <state_machine/MachineDefinition.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class TState {
+  Idle,
+  Active,
+  Stopped,
+  Canceled,
+  MAX_VALUE,
+};
+
+enum class TEvent {
+  Start,
+  Timeout,
+  Cancel,
+  Restart,
+  MAX_VALUE,
+};
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Single-threaded semantics match FSMInstance
+  {
+    sm::MachineDefinition<TState, TEvent> def;
+    def.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    def.attachTransitionGuard(TState::Active,
+                              [](TState, TState, TEvent) { return false; });
+    def.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+
+    sm::ConcurrentFSM<TState, TEvent> fsm(def, TState::Idle);
+    auto missing = fsm.processEvent(TEvent::Cancel);
+    ts.expect_true(!missing.has_value() &&
+                       missing.error() == sm::ProcessEventErr::NoNextStateFound,
+                   "Missing transition yields NoNextStateFound");
+    auto r = fsm.processEvent(TEvent::Start);
+    ts.expect_true(r.has_value() && *r == TState::Active,
+                   "Defined transition commits");
+    auto blocked = fsm.processEvent(TEvent::Timeout);
+    ts.expect_true(!blocked.has_value() &&
+                       blocked.error() ==
+                           sm::ProcessEventErr::TransitionForbidden,
+                   "Guard yields TransitionForbidden");
+    ts.expect_eq(fsm.getCurrentState(std::memory_order_relaxed),
+                 TState::Active, "State unchanged after guard");
+  }
+
+  // Test 2: Contending producers; every commit runs callbacks exactly once
+  {
+    // Start and Timeout toggle between Idle and Active, so every event sent
+    // from the matching state commits exactly one transition.
+    sm::MachineDefinition<TState, TEvent> def;
+    def.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    def.enableTransition(TState::Active, TState::Idle, TEvent::Timeout);
+
+    std::atomic<int> exits{0};
+    std::atomic<int> enters{0};
+    def.attachOnExitStateCallback(
+        TState::Idle, [&](sm::TransitionType, TState, TState, TEvent) {
+          exits.fetch_add(1, std::memory_order_relaxed);
+        });
+    def.attachOnEnterStateCallback(
+        TState::Active, [&](sm::TransitionType, TState, TState, TEvent) {
+          enters.fetch_add(1, std::memory_order_relaxed);
+        });
+
+    sm::ConcurrentFSM<TState, TEvent> fsm(def, TState::Idle);
+    constexpr int threads = 4;
+    constexpr int perThread = 20000;
+    std::atomic<int> committed{0};
+    std::atomic<bool> stop{false};
+    std::atomic<int> polls{0};
+    {
+      std::vector<std::jthread> workers;
+      for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+          const auto event = (t % 2 == 0) ? TEvent::Start : TEvent::Timeout;
+          for (int i = 0; i < perThread; ++i) {
+            if (fsm.processEvent(event)) {
+              committed.fetch_add(1, std::memory_order_relaxed);
+            }
+          }
+        });
+      }
+      std::jthread reader([&] {
+        while (!stop.load(std::memory_order_relaxed)) {
+          const auto s = fsm.getCurrentState(std::memory_order_relaxed);
+          if (s == TState::Idle || s == TState::Active) {
+            polls.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+      });
+      for (auto &w : workers) {
+        w.join();
+      }
+      stop = true;
+    }
+
+    const int idleToActive = exits.load();
+    ts.expect_eq(idleToActive, enters.load(),
+                 "Exit and Enter callbacks ran once per commit");
+    const int expectedFinal = committed.load() - (2 * idleToActive);
+    const auto finalState = fsm.getCurrentState();
+    ts.expect_true((expectedFinal == 0 && finalState == TState::Idle) ||
+                       (expectedFinal == -1 && finalState == TState::Active),
+                   "Final state consistent with committed transitions");
+    ts.expect_true(polls.load() > 0, "Reader polled without blocking");
+  }
+
+  // Test 3: Only the transition's owner runs the guard, one at a time
+  {
+    sm::MachineDefinition<TState, TEvent> def;
+    def.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    def.enableTransition(TState::Active, TState::Idle, TEvent::Timeout);
+
+    std::atomic<int> inside{0};
+    std::atomic<bool> overlapped{false};
+    std::atomic<int> guardCalls{0};
+    std::atomic<int> allowed{0};
+    const auto guard = [&](TState, TState, TEvent) {
+      if (inside.fetch_add(1, std::memory_order_acq_rel) != 0) {
+        overlapped = true;
+      }
+      const int call = guardCalls.fetch_add(1, std::memory_order_relaxed);
+      inside.fetch_sub(1, std::memory_order_acq_rel);
+      // Forbid every third attempt so rejections release the claim too.
+      if (call % 3 == 2) {
+        return false;
+      }
+      allowed.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    };
+    def.attachTransitionGuard(TState::Idle, guard);
+    def.attachTransitionGuard(TState::Active, guard);
+    def.attachOnExitStateCallback(
+        TState::Idle, [&](sm::TransitionType, TState, TState, TEvent) {
+          if (inside.load(std::memory_order_acquire) != 0) {
+            overlapped = true;
+          }
+        });
+
+    sm::ConcurrentFSM<TState, TEvent> fsm(def, TState::Idle);
+    std::atomic<int> committed{0};
+    std::atomic<int> forbidden{0};
+    {
+      std::vector<std::jthread> workers;
+      for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&, t] {
+          const auto event = (t % 2 == 0) ? TEvent::Start : TEvent::Timeout;
+          for (int i = 0; i < 5000; ++i) {
+            const auto r = fsm.processEvent(event);
+            if (r) {
+              committed.fetch_add(1, std::memory_order_relaxed);
+            } else if (r.error() == sm::ProcessEventErr::TransitionForbidden) {
+              forbidden.fetch_add(1, std::memory_order_relaxed);
+            }
+          }
+        });
+      }
+    }
+    ts.expect_true(!overlapped.load(),
+                   "Guards never overlap each other or Exit callbacks");
+    ts.expect_eq(guardCalls.load(), committed.load() + forbidden.load(),
+                 "Guard runs exactly once per claimed transition");
+    ts.expect_eq(allowed.load(), committed.load(),
+                 "Every allowed guard committed its transition");
+  }
+
+  return ts.summary();
+}
@@ -0,0 +1,182 @@
+// Tests for state_machine::EdgeTransitionTable and per-edge guards/actions.
+
+#include <cstdint>
+#include <expected>
+#include <print>
+#include <string>
+#include <vector>
+
+#include <state_machine/ConcurrentStateMachine.hpp>
+#include <state_machine/EdgeTransitionTable.hpp>
+#include <state_machine/StateMachine.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class TState {
+  Idle,
+  Active,
+  Stopped,
+  Canceled,
+  MAX_VALUE,
+};
+
+enum class TEvent {
+  Start,
+  Timeout,
+  Cancel,
+  Restart,
+  MAX_VALUE,
+};
+
+using Table = sm::EdgeTransitionTable<TState, TEvent>;
+
+// Ids 1 and 2 refer to the first guard / action registered.
+constexpr auto kTable =
+    Table{}
+        .enable(TState::Idle, TState::Active, TEvent::Start, 1, 1)
+        .enable(TState::Active, TState::Stopped, TEvent::Timeout,
+                sm::NoEdgeHook, 2)
+        .enable(TState::Active, TState::Canceled, TEvent::Cancel, 2)
+        .enable(TState::Stopped, TState::Idle, TEvent::Restart);
+
+static_assert(sm::EdgeTableBackend<Table>);
+static_assert(!sm::EdgeTableBackend<sm::TransitionTable<TState, TEvent>>);
+static_assert(sizeof(Table::Cell) == 6);
+static_assert(kTable.lookup(TState::Idle, TEvent::Start) == TState::Active);
+static_assert(kTable.edge(TState::Active, TEvent::Timeout) ==
+              sm::TransitionEdge<TState>{TState::Stopped, sm::NoEdgeHook, 2});
+static_assert(kTable.lookup(TState::Idle, TEvent::Cancel) ==
+              TState::MAX_VALUE);
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Edge guard and action run in order around the state hooks
+  {
+    sm::FSM<TState, TEvent, Table> fsm(TState::Idle);
+    fsm.init(kTable);
+
+    std::vector<std::string> log;
+    bool open = false;
+    const auto startGuard = fsm.addEdgeGuard([&](TState, TState, TEvent) {
+      log.push_back("edge guard");
+      return open;
+    });
+    const auto cancelGuard =
+        fsm.addEdgeGuard([](TState, TState, TEvent) { return false; });
+    const auto startAction =
+        fsm.addEdgeAction([&](TState from, TState to, TEvent) {
+          log.push_back(from == TState::Idle && to == TState::Active
+                            ? "start action"
+                            : "bad args");
+        });
+    const auto stopAction = fsm.addEdgeAction(
+        [&](TState, TState, TEvent) { log.push_back("stop action"); });
+    ts.expect_eq(startGuard, sm::EdgeHookId{1}, "Guard ids start at 1");
+    ts.expect_eq(cancelGuard, sm::EdgeHookId{2}, "Guard ids are sequential");
+    ts.expect_eq(startAction, sm::EdgeHookId{1}, "Action ids start at 1");
+    ts.expect_eq(stopAction, sm::EdgeHookId{2}, "Action ids are sequential");
+
+    fsm.attachTransitionGuard(TState::Idle, [&](TState, TState, TEvent) {
+      log.push_back("state guard");
+      return true;
+    });
+    fsm.attachOnExitStateCallback(
+        TState::Idle, [&](sm::TransitionType, TState, TState, TEvent) {
+          log.push_back("exit");
+        });
+    fsm.attachOnEnterStateCallback(
+        TState::Active, [&](sm::TransitionType, TState, TState, TEvent) {
+          log.push_back("enter");
+        });
+
+    auto r = fsm.processEvent(TEvent::Start);
+    ts.expect_true(!r.has_value() &&
+                       r.error() == sm::ProcessEventErr::TransitionForbidden,
+                   "Edge guard can forbid a transition");
+    ts.expect_true(log == std::vector<std::string>{"state guard", "edge guard"},
+                   "State guard runs before the edge guard");
+
+    open = true;
+    log.clear();
+    r = fsm.processEvent(TEvent::Start);
+    ts.expect_eq(r.value_or(TState::Idle), TState::Active, "Start accepted");
+    ts.expect_true(log == std::vector<std::string>{"state guard", "edge guard",
+                                                   "exit", "start action",
+                                                   "enter"},
+                   "Action runs between Exit and Enter");
+
+    r = fsm.processEvent(TEvent::Cancel);
+    ts.expect_true(!r.has_value(), "Guard 2 forbids Cancel");
+
+    log.clear();
+    r = fsm.processEvent(TEvent::Timeout);
+    ts.expect_eq(r.value_or(TState::Idle), TState::Stopped, "Timeout accepted");
+    ts.expect_true(log == std::vector<std::string>{"stop action"},
+                   "Unguarded edge runs only its action");
+
+    r = fsm.processEvent(TEvent::Restart);
+    ts.expect_eq(r.value_or(TState::Active), TState::Idle,
+                 "Edge without hooks behaves like a plain transition");
+  }
+
+  // Test 2: Runtime-built edges, batches and unregistered ids
+  {
+    sm::FSM<TState, TEvent, Table> fsm(TState::Idle);
+    int actions = 0;
+    const auto count =
+        fsm.addEdgeAction([&actions](TState, TState, TEvent) { ++actions; });
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start,
+                         sm::NoEdgeHook, count);
+    fsm.enableTransition(TState::Active, TState::Idle, TEvent::Restart);
+    fsm.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout, 7,
+                         9);
+
+    const std::vector<TEvent> events{TEvent::Start, TEvent::Restart,
+                                     TEvent::Start, TEvent::Restart};
+    const auto batch = fsm.processEvents(events);
+    ts.expect_eq(batch.consumed, std::size_t{4}, "Batch consumed all events");
+    ts.expect_eq(actions, 2, "Batch path runs edge actions");
+
+    (void)fsm.processEvent(TEvent::Start);
+    ts.expect_eq(fsm.processEvent(TEvent::Timeout).value_or(TState::Idle),
+                 TState::Stopped, "Unregistered ids are treated as none");
+
+    fsm.init();
+    ts.expect_true(!fsm.definition().hasHooks(),
+                   "init() drops edge guards and actions");
+    fsm.enableTransition(TState::Stopped, TState::Idle, TEvent::Restart,
+                         sm::NoEdgeHook, count);
+    (void)fsm.processEvent(TEvent::Restart);
+    ts.expect_eq(actions, 3, "Dropped action is not called");
+  }
+
+  // Test 3: Shared definitions, batched steps and ConcurrentFSM
+  {
+    sm::MachineDefinition<TState, TEvent, Table> def(kTable);
+    int actions = 0;
+    (void)def.addEdgeGuard([](TState, TState, TEvent) { return true; });
+    (void)def.addEdgeGuard([](TState, TState, TEvent) { return false; });
+    (void)def.addEdgeAction([&actions](TState, TState, TEvent) { ++actions; });
+
+    std::vector<TState> states(100, TState::Idle);
+    const std::vector<TEvent> events(100, TEvent::Start);
+    const auto r = def.step(states, events);
+    ts.expect_eq(r.failed, std::size_t{0}, "Batched step passes edge guard");
+    ts.expect_eq(actions, 100, "Batched step runs edge actions");
+    ts.expect_eq(states[99], TState::Active, "Batched step moved machines");
+
+    sm::ConcurrentFSM<TState, TEvent, Table> concurrent(def, TState::Idle);
+    (void)concurrent.processEvent(TEvent::Start);
+    ts.expect_eq(actions, 101, "ConcurrentFSM runs edge actions");
+    const auto cancel = concurrent.processEvent(TEvent::Cancel);
+    ts.expect_true(!cancel.has_value() &&
+                       cancel.error() ==
+                           sm::ProcessEventErr::TransitionForbidden,
+                   "ConcurrentFSM checks edge guards");
+  }
+
+  return ts.summary();
+}
@@ -0,0 +1,194 @@
+// Tests for state_machine::FSMPool.
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <print>
+#include <vector>
+
+#include <state_machine/FSMPool.hpp>
+#include <state_machine/TransitionTable.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class TState {
+  Idle,
+  Active,
+  Stopped,
+  Canceled,
+  MAX_VALUE,
+};
+
+enum class TEvent {
+  Start,
+  Timeout,
+  Cancel,
+  Restart,
+  MAX_VALUE,
+};
+
+constexpr auto kTable =
+    sm::TransitionTable<TState, TEvent>{}
+        .enable(TState::Idle, TState::Active, TEvent::Start)
+        .enable(TState::Active, TState::Stopped, TEvent::Timeout)
+        .enable(TState::Active, TState::Canceled, TEvent::Cancel)
+        .enable(TState::Stopped, TState::Active, TEvent::Restart);
+
+enum class ByteState : std::uint8_t { A, B, C, D, MAX_VALUE };
+enum class ByteEvent : std::uint8_t { X, Y, Z, MAX_VALUE };
+enum class WideState : std::uint16_t { MAX_VALUE = 300 };
+enum class WideEvent : std::uint8_t { MAX_VALUE = 7 };
+
+// Random table + random events; every SIMD level must match the scalar loop.
+template <typename S, typename E> bool kernelsAgree(std::size_t count) {
+  unsigned seed = 2024;
+  const auto next = [&seed](std::size_t bound) {
+    seed = seed * 1103515245u + 12345u;
+    return static_cast<std::size_t>((seed >> 8) % bound);
+  };
+  constexpr auto stateSize = enum_utils::enum_size_v<S>;
+  constexpr auto eventSize = enum_utils::enum_size_v<E>;
+
+  sm::TransitionTable<S, E> table{};
+  for (std::size_t i = 0; i < stateSize * eventSize / 2; ++i) {
+    table.enable(static_cast<S>(next(stateSize)),
+                 static_cast<S>(next(stateSize)),
+                 static_cast<E>(next(eventSize)));
+  }
+
+  std::vector<S> initial(count);
+  for (auto &state : initial) {
+    state = static_cast<S>(next(stateSize));
+  }
+  std::vector<E> events(count);
+  for (auto &event : events) {
+    event = static_cast<E>(next(eventSize));
+  }
+
+  sm::FSMPool<S, E> reference(table, 0, S{});
+  sm::FSMPool<S, E> avx2(table, 0, S{});
+  sm::FSMPool<S, E> avx512(table, 0, S{});
+  reference.setSimdLevel(sm::SimdLevel::Scalar);
+  avx2.setSimdLevel(sm::SimdLevel::Avx2);
+  avx512.setSimdLevel(sm::SimdLevel::Avx512);
+  for (const auto state : initial) {
+    reference.add(state);
+    avx2.add(state);
+    avx512.add(state);
+  }
+  for (int round = 0; round < 4; ++round) {
+    reference.step(events);
+    avx2.step(events);
+    avx512.step(events);
+  }
+  return std::ranges::equal(reference.states(), avx2.states()) &&
+         std::ranges::equal(reference.states(), avx512.states());
+}
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Pool starts with every machine in the initial state
+  {
+    sm::FSMPool<TState, TEvent> pool(kTable, 8, TState::Idle);
+    ts.expect_eq(pool.size(), std::size_t{8}, "Pool has 8 machines");
+    ts.expect_true(std::ranges::all_of(pool.states(),
+                                       [](TState s) {
+                                         return s == TState::Idle;
+                                       }),
+                   "All machines start Idle");
+  }
+
+  // Test 2: step() applies event i to machine i
+  {
+    sm::FSMPool<TState, TEvent> pool(kTable, 4, TState::Idle);
+    pool.setState(2, TState::Active);
+    pool.setState(3, TState::Stopped);
+
+    const std::array events{TEvent::Start, TEvent::Cancel, TEvent::Timeout,
+                            TEvent::Restart};
+    pool.step(events);
+    ts.expect_eq(pool.getState(0), TState::Active, "Machine 0 Idle->Active");
+    ts.expect_eq(pool.getState(1), TState::Idle,
+                 "Machine 1 unchanged without transition");
+    ts.expect_eq(pool.getState(2), TState::Stopped,
+                 "Machine 2 Active->Stopped");
+    ts.expect_eq(pool.getState(3), TState::Active,
+                 "Machine 3 Stopped->Active");
+  }
+
+  // Test 3: step() with an offset and a short span
+  {
+    sm::FSMPool<TState, TEvent> pool(kTable, 4, TState::Idle);
+    const std::array events{TEvent::Start, TEvent::Start, TEvent::Start};
+    pool.step(events, 2);
+    ts.expect_true(pool.getState(0) == TState::Idle &&
+                       pool.getState(1) == TState::Idle,
+                   "Machines before offset untouched");
+    ts.expect_true(pool.getState(2) == TState::Active &&
+                       pool.getState(3) == TState::Active,
+                   "Machines from offset stepped, extra events ignored");
+  }
+
+  // Test 4: broadcast() and add()
+  {
+    sm::FSMPool<TState, TEvent> pool(kTable, 2, TState::Idle);
+    const auto idx = pool.add(TState::Active);
+    ts.expect_eq(idx, std::size_t{2}, "add() returns new index");
+    pool.broadcast(TEvent::Start);
+    ts.expect_true(pool.getState(0) == TState::Active &&
+                       pool.getState(1) == TState::Active,
+                   "broadcast moves Idle machines to Active");
+    ts.expect_eq(pool.getState(2), TState::Active,
+                 "broadcast leaves Active machine without Start edge");
+  }
+
+  // Test 5: Pool matches per-event table semantics on a long random stream
+  {
+    constexpr std::size_t count = 1000;
+    sm::FSMPool<TState, TEvent> pool(kTable, count, TState::Idle);
+    std::vector<TState> expected(count, TState::Idle);
+    std::vector<TEvent> events(count);
+    unsigned seed = 12345;
+    bool same = true;
+    for (int round = 0; round < 16; ++round) {
+      for (auto &ev : events) {
+        seed = seed * 1103515245u + 12345u;
+        ev = static_cast<TEvent>((seed >> 16) % 4);
+      }
+      pool.step(events);
+      for (std::size_t i = 0; i < count; ++i) {
+        const auto next = kTable.lookup(expected[i], events[i]);
+        if (next != TState::MAX_VALUE) {
+          expected[i] = next;
+        }
+        same = same && pool.getState(i) == expected[i];
+      }
+    }
+    ts.expect_true(same, "Pool agrees with table lookups over 16 rounds");
+  }
+
+  // Test 6: Vectorised kernels agree with the scalar loop
+  {
+    std::println("Detected SIMD level: {}",
+                 static_cast<int>(sm::detectSimdLevel()));
+    ts.expect_true(kernelsAgree<ByteState, ByteEvent>(1000 + 37),
+                   "Shuffle kernel (uint8, 16 cells) matches scalar");
+    ts.expect_true(kernelsAgree<WideState, WideEvent>(1000 + 13),
+                   "Gather kernel (uint16 states) matches scalar");
+    ts.expect_true(kernelsAgree<TState, TEvent>(1000 + 5),
+                   "Gather kernel (int states) matches scalar");
+  }
+
+  // Test 7: setSimdLevel never goes above the detected level
+  {
+    sm::FSMPool<TState, TEvent> pool(kTable, 1, TState::Idle);
+    pool.setSimdLevel(sm::SimdLevel::Avx512);
+    ts.expect_true(pool.simdLevel() <= sm::detectSimdLevel(),
+                   "SIMD level clamped to CPU support");
+  }
+
+  return ts.summary();
+}
@@ -0,0 +1,247 @@
+// Tests for state_machine::WorkStealingDeque and FSMScheduler.
+
+#include <atomic>
+#include <cstdint>
+#include <expected>
+#include <print>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <state_machine/FSMScheduler.hpp>
+#include <state_machine/StateMachine.hpp>
+#include <state_machine/WorkStealingDeque.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class TState {
+  Idle,
+  Active,
+  Stopped,
+  Canceled,
+  MAX_VALUE,
+};
+
+enum class TEvent {
+  Start,
+  Timeout,
+  Cancel,
+  Restart,
+  MAX_VALUE,
+};
+
+// Machine that counts its events and detects concurrent use.
+struct CountingMachine {
+  using State = TState;
+  using Event = TEvent;
+
+  std::atomic<bool> *overlap;
+  std::uint32_t processed = 0;
+  bool busy = false;
+
+  std::expected<TState, sm::ProcessEventErr> processEvent(TEvent) {
+    if (std::exchange(busy, true)) {
+      overlap->store(true);
+    }
+    ++processed;
+    busy = false;
+    return TState::Active;
+  }
+};
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Owner pops LIFO, thieves steal FIFO
+  {
+    sm::WorkStealingDeque<int, 8> dq;
+    int items[3] = {1, 2, 3};
+    for (auto &item : items) {
+      dq.push(&item);
+    }
+    ts.expect_eq(*dq.steal(), 1, "Steal takes the oldest item");
+    ts.expect_eq(*dq.pop(), 3, "Pop takes the newest item");
+    ts.expect_eq(*dq.pop(), 2, "Pop takes the remaining item");
+    ts.expect_true(dq.pop() == nullptr && dq.steal() == nullptr,
+                   "Empty deque yields nullptr");
+  }
+
+  // Test 2: Concurrent thieves and owner see every item exactly once
+  {
+    constexpr int count = 100000;
+    std::vector<int> items(count);
+    std::vector<std::atomic<int>> seen(count);
+    sm::WorkStealingDeque<int, 1024> dq;
+    std::atomic<bool> done{false};
+    const auto take = [&](int *item) {
+      seen[static_cast<std::size_t>(item - items.data())].fetch_add(1);
+    };
+    {
+      std::vector<std::jthread> thieves;
+      for (int t = 0; t < 3; ++t) {
+        thieves.emplace_back([&] {
+          while (!done.load()) {
+            if (int *item = dq.steal()) {
+              take(item);
+            }
+          }
+        });
+      }
+      for (auto &item : items) {
+        while (!dq.push(&item)) {
+          if (int *popped = dq.pop()) {
+            take(popped);
+          }
+        }
+      }
+      while (int *item = dq.pop()) {
+        take(item);
+      }
+      while (!dq.empty()) {
+        std::this_thread::yield();
+      }
+      done = true;
+    }
+    bool once = true;
+    for (const auto &s : seen) {
+      once = once && s.load() == 1;
+    }
+    ts.expect_true(once, "Each item taken exactly once under stealing");
+  }
+
+  // Test 3: Many machines, external producers, one worker per machine
+  {
+    constexpr std::size_t machines = 2000;
+    constexpr std::uint32_t perMachine = 50;
+    std::atomic<bool> overlap{false};
+    std::atomic<std::size_t> completions{0};
+    std::atomic<bool> offWorker{false};
+
+    sm::FSMScheduler<CountingMachine> *schedPtr = nullptr;
+    sm::FSMScheduler<CountingMachine> sched(
+        4, [&](sm::MachineId, TEvent, auto) {
+          completions.fetch_add(1, std::memory_order_relaxed);
+          if (!schedPtr->currentWorker()) {
+            offWorker = true;
+          }
+        });
+    schedPtr = &sched;
+    for (std::size_t i = 0; i < machines; ++i) {
+      sched.addMachine(CountingMachine{&overlap});
+    }
+    sched.start();
+    {
+      std::vector<std::jthread> producers;
+      for (int p = 0; p < 2; ++p) {
+        producers.emplace_back([&] {
+          for (std::uint32_t round = 0; round < perMachine / 2; ++round) {
+            for (std::size_t m = 0; m < machines; ++m) {
+              while (!sched.post(m, TEvent::Start)) {
+                std::this_thread::yield();
+              }
+            }
+          }
+        });
+      }
+    }
+    sched.stop();
+
+    bool exact = true;
+    for (std::size_t m = 0; m < machines; ++m) {
+      exact = exact && sched.machine(m).processed == perMachine;
+    }
+    ts.expect_true(exact, "Every machine processed all of its events");
+    ts.expect_eq(completions.load(), machines * perMachine,
+                 "Completion handler ran once per event");
+    ts.expect_true(!overlap.load(), "No machine ran on two workers at once");
+    ts.expect_true(!offWorker.load(), "Completions ran on worker threads");
+    ts.expect_true(!sched.post(0, TEvent::Start),
+                   "post() fails once stopped");
+  }
+
+  // Test 4: FSM callbacks run on workers and may post to other machines
+  {
+    constexpr std::size_t machines = 64;
+    constexpr int hops = 10000;
+    using Scheduler = sm::FSMScheduler<sm::FSM<TState, TEvent>>;
+    Scheduler *schedPtr = nullptr;
+    std::atomic<int> remaining{hops};
+    std::atomic<bool> offWorker{false};
+
+    Scheduler sched(4);
+    schedPtr = &sched;
+    for (std::size_t i = 0; i < machines; ++i) {
+      sm::FSM<TState, TEvent> fsm(TState::Idle);
+      fsm.init();
+      fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+      fsm.enableTransition(TState::Active, TState::Idle, TEvent::Start);
+      fsm.attachOnEnterStateCallback(
+          TState::Active, [&, i](sm::TransitionType, TState, TState, TEvent) {
+            if (!schedPtr->currentWorker()) {
+              offWorker = true;
+            }
+            if (remaining.fetch_sub(1) > 1) {
+              schedPtr->post((i + 1) % machines, TEvent::Start);
+            }
+          });
+      fsm.attachOnEnterStateCallback(
+          TState::Idle, [&, i](sm::TransitionType, TState, TState, TEvent) {
+            if (remaining.fetch_sub(1) > 1) {
+              schedPtr->post((i + 7) % machines, TEvent::Start);
+            }
+          });
+      sched.addMachine(std::move(fsm));
+    }
+    sched.start();
+    sched.post(0, TEvent::Start);
+    while (remaining.load() > 0) {
+      std::this_thread::yield();
+    }
+    sched.stop();
+    ts.expect_true(remaining.load() <= 0, "Event chain ran to completion");
+    ts.expect_true(!offWorker.load(), "Enter callbacks ran on worker threads");
+  }
+
+  // Test 5: Posts racing stop() are either rejected or processed
+  {
+    constexpr std::size_t machines = 64;
+    bool allProcessed = true;
+    bool rejectedAfterStop = true;
+    for (int round = 0; round < 20; ++round) {
+      std::atomic<bool> overlap{false};
+      std::atomic<bool> posting{false};
+      std::atomic<std::size_t> accepted{0};
+      sm::FSMScheduler<CountingMachine> sched(2);
+      for (std::size_t i = 0; i < machines; ++i) {
+        sched.addMachine(CountingMachine{&overlap});
+      }
+      sched.start();
+      std::jthread producer([&] {
+        for (std::size_t n = 0; n < 200000; ++n) {
+          if (sched.post(n % machines, TEvent::Start)) {
+            accepted.fetch_add(1, std::memory_order_relaxed);
+          }
+          posting.store(true, std::memory_order_relaxed);
+        }
+      });
+      while (!posting.load(std::memory_order_relaxed)) {
+        std::this_thread::yield();
+      }
+      sched.stop();
+      std::size_t processed = 0;
+      for (std::size_t m = 0; m < machines; ++m) {
+        processed += sched.machine(m).processed;
+      }
+      producer.join();
+      allProcessed = allProcessed && processed == accepted.load();
+      rejectedAfterStop = rejectedAfterStop && !sched.post(0, TEvent::Start);
+    }
+    ts.expect_true(allProcessed,
+                   "Every post accepted during stop() was processed");
+    ts.expect_true(rejectedAfterStop, "Posts after stop() are rejected");
+  }
+
+  return ts.summary();
+}
@@ -0,0 +1,197 @@
+// Tests for state_machine::HierarchicalFSM.
+
+#include <expected>
+#include <print>
+#include <string>
+#include <vector>
+
+#include <state_machine/HierarchicalStateMachine.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+// On { Idle, Running { Fast, Slow } }, Off, Canceled
+enum class HState {
+  Off,
+  On,
+  Idle,
+  Running,
+  Fast,
+  Slow,
+  Canceled,
+  MAX_VALUE,
+};
+
+enum class HEvent {
+  Start,
+  Toggle,
+  Reset,
+  Cancel,
+  MAX_VALUE,
+};
+
+using Machine = sm::HierarchicalFSM<HState, HEvent>;
+
+static const char *name(HState s) {
+  switch (s) {
+  case HState::Off:
+    return "Off";
+  case HState::On:
+    return "On";
+  case HState::Idle:
+    return "Idle";
+  case HState::Running:
+    return "Running";
+  case HState::Fast:
+    return "Fast";
+  case HState::Slow:
+    return "Slow";
+  case HState::Canceled:
+    return "Canceled";
+  default:
+    return "?";
+  }
+}
+
+static Machine makeMachine(std::vector<std::string> &log) {
+  Machine fsm(HState::Idle);
+  fsm.init();
+  fsm.setParent(HState::Idle, HState::On);
+  fsm.setParent(HState::Running, HState::On);
+  fsm.setParent(HState::Fast, HState::Running);
+  fsm.setParent(HState::Slow, HState::Running);
+
+  fsm.enableTransition(HState::Idle, HState::Fast, HEvent::Start);
+  fsm.enableTransition(HState::Fast, HState::Slow, HEvent::Toggle);
+  fsm.enableTransition(HState::Slow, HState::Fast, HEvent::Toggle);
+  fsm.enableTransition(HState::Running, HState::Running, HEvent::Reset);
+  fsm.enableTransition(HState::On, HState::Canceled, HEvent::Cancel);
+
+  for (auto s : {HState::On, HState::Idle, HState::Running, HState::Fast,
+                 HState::Slow, HState::Canceled}) {
+    fsm.attachOnExitStateCallback(
+        s, [&log, s](sm::TransitionType, HState, HState, HEvent) {
+          log.push_back(std::string("exit ") + name(s));
+        });
+    fsm.attachOnEnterStateCallback(
+        s, [&log, s](sm::TransitionType, HState, HState, HEvent) {
+          log.push_back(std::string("enter ") + name(s));
+        });
+  }
+  return fsm;
+}
+
+using Log = std::vector<std::string>;
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Entering a nested state enters only below the common ancestor
+  {
+    Log log;
+    Machine fsm = makeMachine(log);
+    auto r = fsm.processEvent(HEvent::Start);
+    ts.expect_true(r.has_value() && *r == HState::Fast, "Idle -> Fast");
+    ts.expect_true(log == Log{"exit Idle", "enter Running", "enter Fast"},
+                   "Exit Idle, enter Running then Fast (On stays active)");
+    ts.expect_true(fsm.isIn(HState::Running) && fsm.isIn(HState::On) &&
+                       !fsm.isIn(HState::Idle),
+                   "isIn() covers ancestors");
+  }
+
+  // Test 2: Sibling transition leaves the parent untouched
+  {
+    Log log;
+    Machine fsm = makeMachine(log);
+    (void)fsm.processEvent(HEvent::Start);
+    log.clear();
+    (void)fsm.processEvent(HEvent::Toggle);
+    ts.expect_eq(fsm.getCurrentState(), HState::Slow, "Fast -> Slow");
+    ts.expect_true(log == Log{"exit Fast", "enter Slow"},
+                   "Only the siblings are exited/entered");
+  }
+
+  // Test 3: Transition inherited from a grandparent exits the whole branch
+  {
+    Log log;
+    Machine fsm = makeMachine(log);
+    (void)fsm.processEvent(HEvent::Start);
+    log.clear();
+    auto r = fsm.processEvent(HEvent::Cancel);
+    ts.expect_true(r.has_value() && *r == HState::Canceled,
+                   "Fast inherits On's Cancel transition");
+    ts.expect_true(log == Log{"exit Fast", "exit Running", "exit On",
+                              "enter Canceled"},
+                   "Exits innermost first up to the root");
+  }
+
+  // Test 4: Self-transition on an ancestor exits and re-enters it
+  {
+    Log log;
+    Machine fsm = makeMachine(log);
+    (void)fsm.processEvent(HEvent::Start);
+    log.clear();
+    (void)fsm.processEvent(HEvent::Reset);
+    ts.expect_eq(fsm.getCurrentState(), HState::Running,
+                 "Reset lands in Running");
+    ts.expect_true(log == Log{"exit Fast", "exit Running", "enter Running"},
+                   "External self-transition re-enters Running");
+  }
+
+  // Test 5: A child's own transition overrides the inherited one
+  {
+    Log log;
+    Machine fsm = makeMachine(log);
+    fsm.enableTransition(HState::Idle, HState::Off, HEvent::Cancel);
+    ts.expect_true(!fsm.frozen(), "Configuration change unfreezes");
+    auto r = fsm.processEvent(HEvent::Cancel);
+    ts.expect_true(r.has_value() && *r == HState::Off,
+                   "Idle's Cancel overrides On's");
+    ts.expect_true(fsm.frozen(), "processEvent() refreezes");
+    auto none = fsm.processEvent(HEvent::Toggle);
+    ts.expect_true(!none.has_value() &&
+                       none.error() == sm::ProcessEventErr::NoNextStateFound,
+                   "Root state without transitions reports NoNextStateFound");
+  }
+
+  // Test 6: Guards are inherited unless the state has its own
+  {
+    Log log;
+    Machine fsm = makeMachine(log);
+    bool allow = false;
+    HState guardFrom = HState::MAX_VALUE;
+    fsm.attachTransitionGuard(HState::On, [&](HState from, HState, HEvent) {
+      guardFrom = from;
+      return allow;
+    });
+    fsm.attachTransitionGuard(HState::Idle,
+                              [](HState, HState, HEvent) { return true; });
+    fsm.freeze();
+    ts.expect_true(fsm.processEvent(HEvent::Start).has_value(),
+                   "Idle's own guard replaces On's");
+    auto blocked = fsm.processEvent(HEvent::Cancel);
+    ts.expect_true(!blocked.has_value() &&
+                       blocked.error() ==
+                           sm::ProcessEventErr::TransitionForbidden,
+                   "Fast inherits On's guard");
+    ts.expect_eq(guardFrom, HState::Fast, "Guard sees the actual source");
+    allow = true;
+    ts.expect_true(fsm.processEvent(HEvent::Cancel).has_value(),
+                   "Guard lets the transition through");
+  }
+
+  // Test 7: Cycles are rejected
+  {
+    Log log;
+    Machine fsm = makeMachine(log);
+    ts.expect_true(!fsm.setParent(HState::On, HState::Fast),
+                   "Parenting an ancestor under its descendant fails");
+    ts.expect_true(!fsm.setParent(HState::Slow, HState::Slow),
+                   "A state cannot be its own parent");
+    ts.expect_eq(fsm.parent(HState::On), HState::MAX_VALUE,
+                 "Rejected setParent changes nothing");
+  }
+
+  return ts.summary();
+}
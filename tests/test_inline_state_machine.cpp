@@ -0,0 +1,128 @@
+// Tests for hooks policies used by InlineFSM and StaticFSM.
+
+#include <expected>
+#include <print>
+#include <vector>
+
+#include <state_machine/Hooks.hpp>
+#include <state_machine/InlineStateMachine.hpp>
+#include <state_machine/StaticStateMachine.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class TState {
+  Idle,
+  Active,
+  Stopped,
+  Canceled,
+  MAX_VALUE,
+};
+
+enum class TEvent {
+  Start,
+  Timeout,
+  Cancel,
+  Restart,
+  MAX_VALUE,
+};
+
+constexpr auto kTable =
+    sm::TransitionTable<TState, TEvent>{}
+        .enable(TState::Idle, TState::Active, TEvent::Start)
+        .enable(TState::Active, TState::Stopped, TEvent::Timeout)
+        .enable(TState::Stopped, TState::Active, TEvent::Restart);
+
+struct Record {
+  char kind;
+  TState from;
+  TState to;
+};
+
+struct RecordingHooks {
+  std::vector<Record> *log;
+  bool allow = true;
+
+  bool guard(TState from, TState to, TEvent) {
+    log->push_back({'G', from, to});
+    return allow;
+  }
+  void onExit(TState from, TState to, TEvent) {
+    log->push_back({'X', from, to});
+  }
+  void onEnter(TState from, TState to, TEvent) {
+    log->push_back({'N', from, to});
+  }
+};
+
+struct EnterOnly {
+  int *entered;
+  void onEnter(TState, TState, TEvent) { ++*entered; }
+};
+
+static_assert(!sm::HasGuardHook<EnterOnly, TState, TEvent>);
+static_assert(sm::HasEnterHook<EnterOnly, TState, TEvent>);
+static_assert(sizeof(sm::InlineFSM<TState, TEvent>) ==
+              sizeof(sm::TransitionTable<TState, TEvent>) + sizeof(TState));
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: InlineFSM without hooks behaves like a plain table machine
+  {
+    sm::InlineFSM<TState, TEvent> fsm(TState::Idle, kTable);
+    auto r = fsm.processEvent(TEvent::Start);
+    ts.expect_true(r.has_value(), "InlineFSM transitions");
+    ts.expect_eq(fsm.getCurrentState(), TState::Active, "InlineFSM is Active");
+    auto missing = fsm.processEvent(TEvent::Start);
+    ts.expect_true(!missing.has_value() &&
+                       missing.error() == sm::ProcessEventErr::NoNextStateFound,
+                   "InlineFSM reports NoNextStateFound");
+  }
+
+  // Test 2: Hooks run in guard, exit, enter order
+  {
+    std::vector<Record> log;
+    sm::InlineFSM<TState, TEvent, RecordingHooks> fsm(TState::Idle,
+                                                      RecordingHooks{&log});
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    (void)fsm.processEvent(TEvent::Start);
+    ts.expect_eq(log.size(), std::size_t{3}, "Three hooks fired");
+    if (log.size() == 3) {
+      ts.expect_true(log[0].kind == 'G' && log[1].kind == 'X' &&
+                         log[2].kind == 'N',
+                     "Order is guard, exit, enter");
+      ts.expect_true(log[2].from == TState::Idle && log[2].to == TState::Active,
+                     "Enter receives previous and new state");
+    }
+  }
+
+  // Test 3: Guard hook forbids the transition
+  {
+    std::vector<Record> log;
+    sm::InlineFSM<TState, TEvent, RecordingHooks> fsm(
+        TState::Idle, kTable, RecordingHooks{&log, false});
+    auto r = fsm.processEvent(TEvent::Start);
+    ts.expect_true(!r.has_value() &&
+                       r.error() == sm::ProcessEventErr::TransitionForbidden,
+                   "Guard hook yields TransitionForbidden");
+    ts.expect_eq(fsm.getCurrentState(), TState::Idle,
+                 "State unchanged when guard hook blocks");
+    ts.expect_eq(log.size(), std::size_t{1}, "No callbacks after blocked guard");
+  }
+
+  // Test 4: StaticFSM with a partial hooks policy
+  {
+    int entered = 0;
+    sm::StaticFSM<kTable, EnterOnly> fsm(TState::Idle, EnterOnly{&entered});
+    (void)fsm.processEvent(TEvent::Start);
+    (void)fsm.processEvent(TEvent::Timeout);
+    (void)fsm.processEvent(TEvent::Cancel);
+    ts.expect_eq(entered, 2, "Enter hook ran for both transitions only");
+    ts.expect_eq(fsm.getCurrentState(), TState::Stopped,
+                 "StaticFSM with hooks reaches Stopped");
+  }
+
+  return ts.summary();
+}
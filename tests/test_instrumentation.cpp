@@ -0,0 +1,215 @@
+// Tests for the FSM instrumentation policy and TransitionStats.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <print>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <state_machine/Instrumentation.hpp>
+#include <state_machine/StateMachine.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class IState {
+  Idle,
+  Running,
+  Done,
+  MAX_VALUE,
+};
+
+enum class IEvent {
+  Start,
+  Finish,
+  Reset,
+  MAX_VALUE,
+};
+
+using Stats = sm::TransitionStats<IState, IEvent>;
+using Counting = sm::CountingInstrumentation<IState, IEvent>;
+using Timed = sm::CountingInstrumentation<IState, IEvent, true>;
+using CountingFSM = sm::FSM<IState, IEvent, sm::TransitionTable<IState, IEvent>,
+                            Counting>;
+using TimedFSM =
+    sm::FSM<IState, IEvent, sm::TransitionTable<IState, IEvent>, Timed>;
+
+static_assert(!sm::is_instrumented_v<sm::NoInstrumentation, IState, IEvent>);
+static_assert(sm::is_instrumented_v<Counting, IState, IEvent>);
+static_assert(!sm::TimesCallbacks<Counting, IState, IEvent>);
+static_assert(sm::TimesCallbacks<Timed, IState, IEvent>);
+// Stateless policies, NoInstrumentation included, occupy no storage.
+struct StatelessPolicy {
+  void onTransition(IState, IState, IEvent) {}
+};
+static_assert(std::is_empty_v<sm::NoInstrumentation>);
+static_assert(sizeof(sm::FSM<IState, IEvent>) ==
+              sizeof(sm::FSM<IState, IEvent,
+                             sm::TransitionTable<IState, IEvent>,
+                             StatelessPolicy>));
+
+template <typename Machine> static void configure(Machine &fsm) {
+  fsm.init();
+  fsm.enableTransition(IState::Idle, IState::Running, IEvent::Start);
+  fsm.enableTransition(IState::Running, IState::Done, IEvent::Finish);
+  fsm.enableTransition(IState::Done, IState::Idle, IEvent::Reset);
+}
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Hits are counted per (state, event)
+  {
+    Stats stats{};
+    CountingFSM fsm(IState::Idle, Counting(stats));
+    configure(fsm);
+    for (int i = 0; i < 3; ++i) {
+      (void)fsm.processEvent(IEvent::Start);
+      (void)fsm.processEvent(IEvent::Finish);
+      (void)fsm.processEvent(IEvent::Reset);
+    }
+    (void)fsm.processEvent(IEvent::Start);
+    ts.expect_eq(stats.hits(IState::Idle, IEvent::Start), std::uint64_t{4},
+                 "Idle/Start counted");
+    ts.expect_eq(stats.hits(IState::Running, IEvent::Finish), std::uint64_t{3},
+                 "Running/Finish counted");
+    ts.expect_eq(stats.hits(IState::Done, IEvent::Start), std::uint64_t{0},
+                 "Untaken cell stays zero");
+    ts.expect_eq(fsm.getCurrentState(), IState::Running,
+                 "Instrumented machine transitions normally");
+  }
+
+  // Test 2: Rejections are counted by kind
+  {
+    Stats stats{};
+    CountingFSM fsm(IState::Idle, Counting(stats));
+    configure(fsm);
+    (void)fsm.processEvent(IEvent::Finish);
+    (void)fsm.processEvent(IEvent::Finish);
+    fsm.attachTransitionGuard(IState::Idle,
+                              [](IState, IState, IEvent) { return false; });
+    const auto r = fsm.processEvent(IEvent::Start);
+    ts.expect_true(!r && r.error() == sm::ProcessEventErr::TransitionForbidden,
+                   "Guard still rejects");
+    ts.expect_eq(stats.rejections(IState::Idle, IEvent::Finish,
+                                  sm::ProcessEventErr::NoNextStateFound),
+                 std::uint64_t{2}, "NoNextStateFound counted");
+    ts.expect_eq(stats.rejections(IState::Idle, IEvent::Start,
+                                  sm::ProcessEventErr::TransitionForbidden),
+                 std::uint64_t{1}, "TransitionForbidden counted");
+    ts.expect_eq(stats.rejections(sm::ProcessEventErr::TransitionForbidden),
+                 std::uint64_t{1}, "Per-kind total");
+    ts.expect_eq(stats.hits(IState::Idle, IEvent::Start), std::uint64_t{0},
+                 "Rejected event is not a hit");
+  }
+
+  // Test 3: Batches and deferred events are counted too
+  {
+    Stats stats{};
+    CountingFSM fsm(IState::Idle, Counting(stats));
+    configure(fsm);
+    fsm.attachOnEnterStateCallback(
+        IState::Done, [&fsm](sm::TransitionType, IState, IState, IEvent) {
+          (void)fsm.processEvent(IEvent::Reset);
+        });
+    const std::array events{IEvent::Start, IEvent::Finish, IEvent::Finish};
+    std::vector<IState> seen;
+    const auto result = fsm.processEvents(events, std::back_inserter(seen),
+                                          sm::BatchErrorPolicy::ContinueOnError);
+    ts.expect_eq(result.consumed, std::size_t{3}, "Whole batch consumed");
+    ts.expect_eq(result.failed, std::size_t{1}, "One failure");
+    ts.expect_eq(seen.size(), std::size_t{3}, "One state per event");
+    ts.expect_eq(seen[1], IState::Idle, "Deferred Reset drained in batch");
+    ts.expect_eq(stats.hits(IState::Done, IEvent::Reset), std::uint64_t{1},
+                 "Deferred event counted");
+    ts.expect_eq(stats.rejections(IState::Idle, IEvent::Finish,
+                                  sm::ProcessEventErr::NoNextStateFound),
+                 std::uint64_t{1}, "Batch rejection counted");
+  }
+
+  // Test 4: A full deferred queue counts as a rejection
+  {
+    Stats stats{};
+    CountingFSM fsm(IState::Idle, Counting(stats));
+    configure(fsm);
+    fsm.attachOnEnterStateCallback(
+        IState::Running, [&fsm](sm::TransitionType, IState, IState, IEvent) {
+          for (std::size_t i = 0; i < CountingFSM::DeferredCapacity + 2; ++i) {
+            (void)fsm.processEvent(IEvent::Reset);
+          }
+        });
+    (void)fsm.processEvent(IEvent::Start);
+    ts.expect_eq(stats.rejections(sm::ProcessEventErr::DeferredQueueFull),
+                 std::uint64_t{2}, "Overflowing deferrals counted");
+  }
+
+  // Test 5: Callback timing fills the histogram
+  {
+    Stats stats{};
+    TimedFSM fsm(IState::Idle, Timed(stats));
+    configure(fsm);
+    fsm.attachOnEnterStateCallback(
+        IState::Running, [](sm::TransitionType, IState, IState, IEvent) {
+          std::this_thread::sleep_for(std::chrono::microseconds(50));
+        });
+    (void)fsm.processEvent(IEvent::Start);
+    (void)fsm.processEvent(IEvent::Finish);
+    const auto histogram = stats.callbackHistogram();
+    std::uint64_t total = 0;
+    std::uint64_t slow = 0;
+    for (std::size_t i = 0; i < histogram.size(); ++i) {
+      total += histogram[i];
+      // 2^15 ns is about 33 us.
+      if (i >= 15) {
+        slow += histogram[i];
+      }
+    }
+    ts.expect_eq(total, std::uint64_t{2}, "One sample per transition");
+    ts.expect_true(slow >= 1, "Sleeping callback lands in a slow bucket");
+  }
+
+  // Test 6: Machines share one stats object, across threads too
+  {
+    Stats stats{};
+    constexpr int Threads = 4;
+    constexpr int Rounds = 1000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < Threads; ++t) {
+      workers.emplace_back([&stats] {
+        CountingFSM fsm(IState::Idle, Counting(stats));
+        configure(fsm);
+        for (int i = 0; i < Rounds; ++i) {
+          (void)fsm.processEvent(IEvent::Start);
+          (void)fsm.processEvent(IEvent::Finish);
+          (void)fsm.processEvent(IEvent::Reset);
+        }
+      });
+    }
+    for (auto &w : workers) {
+      w.join();
+    }
+    ts.expect_eq(stats.hits(IState::Idle, IEvent::Start),
+                 std::uint64_t{Threads * Rounds}, "Counts aggregate");
+
+    CountingFSM copy(IState::Idle, Counting(stats));
+    auto second = copy;
+    configure(second);
+    (void)second.processEvent(IEvent::Start);
+    ts.expect_eq(stats.hits(IState::Idle, IEvent::Start),
+                 std::uint64_t{(Threads * Rounds) + 1},
+                 "Copies record into the same stats");
+    ts.expect_true(&second.instrumentation().stats() == &stats,
+                   "Policy exposes its stats");
+
+    stats.reset();
+    ts.expect_eq(stats.hits(IState::Idle, IEvent::Start), std::uint64_t{0},
+                 "Reset clears counters");
+  }
+
+  return ts.summary();
+}
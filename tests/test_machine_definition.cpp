@@ -0,0 +1,274 @@
+// Tests for state_machine::MachineDefinition and FSMInstance.
+
+#include <algorithm>
+#include <expected>
+#include <optional>
+#include <print>
+#include <span>
+#include <vector>
+
+#include <state_machine/MachineDefinition.hpp>
+#include <state_machine/StateMachine.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class TState {
+  Idle,
+  Active,
+  Stopped,
+  Canceled,
+  MAX_VALUE,
+};
+
+enum class TEvent {
+  Start,
+  Timeout,
+  Cancel,
+  Restart,
+  MAX_VALUE,
+};
+
+static_assert(sizeof(sm::FSMInstance<TState, TEvent>) <= 2 * sizeof(void *));
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Instances sharing one definition keep independent states
+  {
+    sm::MachineDefinition<TState, TEvent> def;
+    def.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    def.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+
+    sm::FSMInstance<TState, TEvent> a(def, TState::Idle);
+    sm::FSMInstance<TState, TEvent> b(def, TState::Idle);
+
+    auto r = a.processEvent(TEvent::Start);
+    ts.expect_true(r.has_value(), "Instance A transitions");
+    ts.expect_eq(a.getCurrentState(), TState::Active, "Instance A is Active");
+    ts.expect_eq(b.getCurrentState(), TState::Idle,
+                 "Instance B unaffected by A");
+
+    auto missing = b.processEvent(TEvent::Timeout);
+    ts.expect_true(!missing.has_value(), "Instance B rejects Timeout in Idle");
+    if (!missing.has_value()) {
+      ts.expect_eq(missing.error(), sm::ProcessEventErr::NoNextStateFound,
+                   "Error is NoNextStateFound");
+    }
+  }
+
+  // Test 2: Guards and callbacks on the definition apply to every instance
+  {
+    sm::MachineDefinition<TState, TEvent> def;
+    def.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+
+    std::vector<sm::TransitionType> log;
+    def.attachOnExitStateCallback(
+        TState::Idle, [&](sm::TransitionType type, TState, TState, TEvent) {
+          log.push_back(type);
+        });
+    def.attachOnEnterStateCallback(
+        TState::Active, [&](sm::TransitionType type, TState, TState, TEvent) {
+          log.push_back(type);
+        });
+
+    sm::FSMInstance<TState, TEvent> a(def, TState::Idle);
+    sm::FSMInstance<TState, TEvent> b(def, TState::Idle);
+    (void)a.processEvent(TEvent::Start);
+    (void)b.processEvent(TEvent::Start);
+
+    ts.expect_eq(log.size(), std::size_t{4},
+                 "Exit and Enter fired for both instances");
+    if (log.size() == 4) {
+      ts.expect_true(log[0] == sm::TransitionType::Exit &&
+                         log[1] == sm::TransitionType::Enter,
+                     "Exit runs before Enter");
+    }
+
+    def.attachTransitionGuard(TState::Idle,
+                              [](TState, TState, TEvent) { return false; });
+    sm::FSMInstance<TState, TEvent> c(def, TState::Idle);
+    auto r = c.processEvent(TEvent::Start);
+    ts.expect_true(!r.has_value(), "Guard on definition blocks instance");
+    if (!r.has_value()) {
+      ts.expect_eq(r.error(), sm::ProcessEventErr::TransitionForbidden,
+                   "Error is TransitionForbidden");
+    }
+  }
+
+  // Test 3: Definition built from a constexpr table
+  {
+    constexpr auto table =
+        sm::TransitionTable<TState, TEvent>{}
+            .enable(TState::Idle, TState::Active, TEvent::Start)
+            .enable(TState::Active, TState::Canceled, TEvent::Cancel);
+    const sm::MachineDefinition<TState, TEvent> def(table);
+    sm::FSMInstance<TState, TEvent> inst(def, TState::Idle);
+    (void)inst.processEvent(TEvent::Start);
+    (void)inst.processEvent(TEvent::Cancel);
+    ts.expect_eq(inst.getCurrentState(), TState::Canceled,
+                 "Instance follows table-built definition");
+    ts.expect_true(def.table() == table, "Definition exposes its table");
+  }
+
+  // Test 4: FSM keeps its own definition
+  {
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.init();
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    ts.expect_eq(fsm.definition().computeTransition(TState::Idle,
+                                                    TEvent::Start),
+                 TState::Active, "FSM exposes its definition");
+  }
+
+  // Test 5: Callbacks attached in any interleaving fire per slot in order
+  {
+    sm::MachineDefinition<TState, TEvent> def;
+    def.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    def.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+
+    std::vector<int> log;
+    const auto record = [&log](int id) {
+      return [&log, id](sm::TransitionType, TState, TState, TEvent) {
+        log.push_back(id);
+      };
+    };
+    def.attachOnEnterStateCallback(TState::Stopped, record(6));
+    def.attachOnExitStateCallback(TState::Idle, record(1));
+    def.attachOnEnterStateCallback(TState::Active, record(3));
+    def.attachOnExitStateCallback(TState::Active, record(5));
+    def.attachOnExitStateCallback(TState::Idle, record(2));
+    def.attachOnEnterStateCallback(TState::Active, record(4));
+    def.attachOnEnterStateCallback(TState::Stopped, record(7));
+
+    TState state = TState::Idle;
+    (void)def.processEvent(state, TEvent::Start);
+    (void)def.processEvent(state, TEvent::Timeout);
+    ts.expect_true(log == std::vector{1, 2, 3, 4, 5, 6, 7},
+                   "Exit/Enter callbacks fire per slot in attach order");
+
+    def.init();
+    log.clear();
+    def.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    state = TState::Idle;
+    (void)def.processEvent(state, TEvent::Start);
+    ts.expect_true(log.empty(), "init() drops all packed callbacks");
+  }
+
+  // Test 6: Pure guards run once per (state, event) until invalidated
+  {
+    sm::MachineDefinition<TState, TEvent> def;
+    def.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    def.enableTransition(TState::Idle, TState::Canceled, TEvent::Cancel);
+    def.enableTransition(TState::Active, TState::Idle, TEvent::Restart);
+
+    int calls = 0;
+    bool open = true;
+    def.attachTransitionGuard(
+        TState::Idle,
+        [&calls, &open](TState, TState, TEvent) {
+          ++calls;
+          return open;
+        },
+        sm::GuardPurity::Pure);
+
+    TState state = TState::Idle;
+    for (int i = 0; i < 3; ++i) {
+      (void)def.processEvent(state, TEvent::Start);
+      (void)def.processEvent(state, TEvent::Restart);
+    }
+    ts.expect_eq(state, TState::Idle, "Pure guard allows the round trips");
+    ts.expect_eq(calls, 1, "Pure guard called once for (Idle, Start)");
+
+    open = false;
+    ts.expect_true(def.processEvent(state, TEvent::Start).has_value(),
+                   "Cached result is used until invalidated");
+    (void)def.processEvent(state, TEvent::Restart);
+    def.invalidateGuards();
+    auto r = def.processEvent(state, TEvent::Start);
+    ts.expect_true(!r.has_value() &&
+                       r.error() == sm::ProcessEventErr::TransitionForbidden,
+                   "invalidateGuards() re-evaluates the guard");
+    (void)def.processEvent(state, TEvent::Start);
+    ts.expect_eq(calls, 2, "Rejections are cached too");
+    (void)def.processEvent(state, TEvent::Cancel);
+    ts.expect_eq(calls, 3, "Each (state, event) cell is cached separately");
+
+    def.enableTransition(TState::Idle, TState::Stopped, TEvent::Start);
+    open = true;
+    ts.expect_eq(def.processEvent(state, TEvent::Start).value_or(TState::Idle),
+                 TState::Stopped, "Reconfiguration drops cached results");
+
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    fsm.enableTransition(TState::Active, TState::Idle, TEvent::Restart);
+    int fsmCalls = 0;
+    fsm.attachTransitionGuard(
+        TState::Idle,
+        [&fsmCalls](TState, TState, TEvent) {
+          ++fsmCalls;
+          return true;
+        },
+        sm::GuardPurity::Pure);
+    (void)fsm.processEvent(TEvent::Start);
+    (void)fsm.processEvent(TEvent::Restart);
+    fsm.invalidateGuards();
+    (void)fsm.processEvent(TEvent::Start);
+    ts.expect_eq(fsmCalls, 2, "FSM forwards purity and invalidateGuards()");
+  }
+
+  // Test 7: Batched step over many machines sharing a definition
+  {
+    sm::MachineDefinition<TState, TEvent> def;
+    def.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    def.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+    def.enableTransition(TState::Active, TState::Canceled, TEvent::Cancel);
+
+    std::vector<TState> states(150, TState::Idle);
+    std::vector<TEvent> events(150, TEvent::Start);
+    auto r = def.step(states, events);
+    ts.expect_eq(r.consumed, std::size_t{150}, "Hook-free step consumes all");
+    ts.expect_eq(r.failed, std::size_t{0}, "Hook-free step has no failures");
+    ts.expect_true(std::ranges::all_of(
+                       states, [](TState s) { return s == TState::Active; }),
+                   "Every machine moved to Active");
+
+    int guardCalls = 0;
+    def.attachTransitionGuard(
+        TState::Active,
+        [&guardCalls](TState, TState to, TEvent) {
+          ++guardCalls;
+          return to != TState::Canceled;
+        },
+        sm::GuardPurity::Pure);
+    std::vector<int> entered;
+    def.attachOnEnterStateCallback(
+        TState::Stopped,
+        [&entered, &guardCalls](sm::TransitionType, TState, TState, TEvent) {
+          entered.push_back(guardCalls);
+        });
+
+    for (std::size_t i = 0; i < events.size(); ++i) {
+      events[i] = i % 3 == 0   ? TEvent::Timeout
+                  : i % 3 == 1 ? TEvent::Cancel
+                               : TEvent::Restart;
+    }
+    r = def.step(std::span(states), std::span(events).first(149));
+    ts.expect_eq(r.consumed, std::size_t{149}, "Step stops at shorter span");
+    ts.expect_eq(r.failed, std::size_t{99}, "Forbidden and missing rejected");
+    ts.expect_eq(r.firstError, std::optional(
+                                   sm::ProcessEventErr::TransitionForbidden),
+                 "First error is from machine 1");
+    ts.expect_eq(states[0], TState::Stopped, "Machine 0 stopped");
+    ts.expect_eq(states[1], TState::Active, "Machine 1 held by the guard");
+    ts.expect_eq(states[2], TState::Active, "Machine 2 has no transition");
+    ts.expect_eq(states[149], TState::Active, "Machine past events untouched");
+    ts.expect_eq(guardCalls, 2, "Pure guard evaluated once per cell");
+    ts.expect_eq(entered.size(), std::size_t{50}, "Enter callbacks ran");
+    ts.expect_true(!entered.empty() && entered.front() == 2,
+                   "Guards of a chunk run before its callbacks");
+  }
+
+  return ts.summary();
+}
@@ -0,0 +1,215 @@
+// Tests for state_machine::minimize() and FSM::minimize().
+
+#include <array>
+#include <cstddef>
+#include <expected>
+#include <map>
+#include <print>
+#include <random>
+#include <vector>
+
+#include <state_machine/Minimize.hpp>
+#include <state_machine/SparseTransitionTable.hpp>
+#include <state_machine/StateMachine.hpp>
+#include <state_machine/TransitionTable.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class MState {
+  S0,
+  S1,
+  S2,
+  S3,
+  S4,
+  S5,
+  S6,
+  S7,
+  MAX_VALUE,
+};
+
+enum class MEvent {
+  A,
+  B,
+  C,
+  MAX_VALUE,
+};
+
+using Table = sm::TransitionTable<MState, MEvent>;
+
+// S1 and S2 behave alike; S4 and S5 are unreachable from S0.
+static Table makeRedundant() {
+  Table t{};
+  t.enable(MState::S0, MState::S1, MEvent::A)
+      .enable(MState::S0, MState::S2, MEvent::B)
+      .enable(MState::S1, MState::S3, MEvent::A)
+      .enable(MState::S2, MState::S3, MEvent::A)
+      .enable(MState::S3, MState::S0, MEvent::B)
+      .enable(MState::S4, MState::S0, MEvent::A)
+      .enable(MState::S5, MState::S5, MEvent::C);
+  return t;
+}
+
+// Reference: Moore refinement over the reachable states, returns the number
+// of equivalence classes.
+static std::size_t mooreClassCount(const Table &t, MState initial) {
+  constexpr std::size_t N = 8;
+  std::vector<bool> reach(N, false);
+  std::vector<std::size_t> stack{static_cast<std::size_t>(initial)};
+  reach[stack[0]] = true;
+  while (!stack.empty()) {
+    const auto s = stack.back();
+    stack.pop_back();
+    for (std::size_t e = 0; e < 3; ++e) {
+      const auto to = t.lookup(static_cast<MState>(s), static_cast<MEvent>(e));
+      if (to != MState::MAX_VALUE && !reach[static_cast<std::size_t>(to)]) {
+        reach[static_cast<std::size_t>(to)] = true;
+        stack.push_back(static_cast<std::size_t>(to));
+      }
+    }
+  }
+  std::vector<int> cls(N + 1, 0);
+  cls[N] = -1;
+  for (;;) {
+    std::map<std::vector<int>, int> ids;
+    std::vector<int> next(N + 1, -1);
+    for (std::size_t s = 0; s < N; ++s) {
+      if (!reach[s]) {
+        continue;
+      }
+      std::vector<int> sig{cls[s]};
+      for (std::size_t e = 0; e < 3; ++e) {
+        const auto to = t.lookup(static_cast<MState>(s), static_cast<MEvent>(e));
+        sig.push_back(to == MState::MAX_VALUE
+                          ? -1
+                          : cls[static_cast<std::size_t>(to)]);
+      }
+      next[s] = ids.emplace(sig, static_cast<int>(ids.size())).first->second;
+    }
+    if (next == cls) {
+      return ids.size();
+    }
+    cls = next;
+  }
+}
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Equivalent states merge, unreachable states are pruned
+  {
+    const auto m = sm::minimize(makeRedundant(), MState::S0);
+    ts.expect_eq(m.states.count, std::size_t{3}, "Three states survive");
+    ts.expect_eq(m.states(MState::S0), MState::S0, "Initial state becomes 0");
+    ts.expect_eq(m.states(MState::S1), m.states(MState::S2),
+                 "S1 and S2 merged");
+    ts.expect_true(m.states(MState::S4) == MState::MAX_VALUE &&
+                       m.states(MState::S5) == MState::MAX_VALUE,
+                   "Unreachable states pruned");
+    ts.expect_eq(m.table.lookup(m.states(MState::S1), MEvent::A),
+                 m.states(MState::S3), "Merged state keeps its transitions");
+    ts.expect_eq(m.table.lookup(m.states(MState::S3), MEvent::C),
+                 MState::MAX_VALUE, "Missing transitions stay missing");
+  }
+
+  // Test 2: Distinguished states are never merged
+  {
+    const std::array keep{MState::S2};
+    const auto m = sm::minimize(makeRedundant(), MState::S0, keep);
+    ts.expect_eq(m.states.count, std::size_t{4}, "Four states survive");
+    ts.expect_true(m.states(MState::S1) != m.states(MState::S2),
+                   "Distinguished S2 kept apart from S1");
+  }
+
+  // Test 3: A complete cycle with no hooks collapses to one state
+  {
+    Table t{};
+    for (std::size_t s = 0; s < 6; ++s) {
+      t.enable(static_cast<MState>(s), static_cast<MState>((s + 1) % 6),
+               MEvent::A);
+    }
+    const auto m = sm::minimize(t, MState::S0);
+    ts.expect_eq(m.states.count, std::size_t{1}, "Cycle collapses");
+    ts.expect_eq(m.table.lookup(MState::S0, MEvent::A), MState::S0,
+                 "Collapsed cycle is a self-loop");
+  }
+
+  // Test 4: Random tables: minimal, and behaviour-preserving
+  {
+    std::mt19937 rng(42);
+    bool minimal = true;
+    bool same = true;
+    for (int round = 0; round < 500; ++round) {
+      Table t{};
+      for (std::size_t s = 0; s < 8; ++s) {
+        for (std::size_t e = 0; e < 3; ++e) {
+          if (rng() % 4 != 0) {
+            t.enable(static_cast<MState>(s), static_cast<MState>(rng() % 8),
+                     static_cast<MEvent>(e));
+          }
+        }
+      }
+      const auto m = sm::minimize(t, MState::S0);
+      minimal = minimal && m.states.count == mooreClassCount(t, MState::S0);
+
+      MState orig = MState::S0;
+      MState small = m.states(orig);
+      for (int i = 0; i < 200; ++i) {
+        const auto ev = static_cast<MEvent>(rng() % 3);
+        const auto a = t.lookup(orig, ev);
+        const auto b = m.table.lookup(small, ev);
+        same = same && (a == MState::MAX_VALUE) == (b == MState::MAX_VALUE);
+        if (a != MState::MAX_VALUE) {
+          orig = a;
+          small = b;
+        }
+        same = same && m.states(orig) == small;
+      }
+    }
+    ts.expect_true(minimal, "Class count matches Moore refinement");
+    ts.expect_true(same, "Minimized tables accept the same event sequences");
+  }
+
+  // Test 5: Sparse backend minimizes the same way
+  {
+    sm::SparseTransitionTable<MState, MEvent> sparse;
+    sparse.enable(MState::S0, MState::S1, MEvent::A)
+        .enable(MState::S0, MState::S2, MEvent::B)
+        .enable(MState::S1, MState::S3, MEvent::A)
+        .enable(MState::S2, MState::S3, MEvent::A)
+        .enable(MState::S3, MState::S0, MEvent::B);
+    const auto m = sm::minimize(sparse, MState::S0);
+    ts.expect_eq(m.states.count, std::size_t{3}, "Sparse: three states");
+    ts.expect_eq(m.table.size(), std::size_t{4}, "Sparse: four transitions");
+  }
+
+  // Test 6: FSM::minimize keeps hooks on their (renumbered) states
+  {
+    sm::FSM<MState, MEvent> fsm(MState::S0);
+    fsm.init(makeRedundant());
+    int entered = 0;
+    fsm.attachOnEnterStateCallback(
+        MState::S3,
+        [&](sm::TransitionType, MState, MState, MEvent) { ++entered; });
+    fsm.attachTransitionGuard(MState::S2,
+                              [](MState, MState, MEvent) { return false; });
+    const auto map = fsm.minimize();
+    ts.expect_eq(map.count, std::size_t{4}, "Guarded S2 is not merged");
+    ts.expect_eq(fsm.getCurrentState(), map(MState::S0),
+                 "Current state renumbered");
+
+    (void)fsm.processEvent(MEvent::A);
+    (void)fsm.processEvent(MEvent::A);
+    ts.expect_eq(entered, 1, "Enter callback moved with S3");
+    (void)fsm.processEvent(MEvent::B);
+    (void)fsm.processEvent(MEvent::B);
+    ts.expect_eq(fsm.getCurrentState(), map(MState::S2), "Reached S2");
+    auto r = fsm.processEvent(MEvent::A);
+    ts.expect_true(!r.has_value() &&
+                       r.error() == sm::ProcessEventErr::TransitionForbidden,
+                   "Guard moved with S2");
+  }
+
+  return ts.summary();
+}
@@ -0,0 +1,155 @@
+// Tests for state_machine::ParallelFSM and StaticParallelFSM.
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <print>
+#include <random>
+
+#include <state_machine/ParallelStateMachine.hpp>
+#include <state_machine/StateMachine.hpp>
+#include <state_machine/TransitionTable.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class TState {
+  Idle,
+  Active,
+  Stopped,
+  Canceled,
+  MAX_VALUE,
+};
+
+enum class TEvent {
+  Start,
+  Timeout,
+  Cancel,
+  Restart,
+  MAX_VALUE,
+};
+
+enum class AuthState {
+  Anonymous,
+  Authenticated,
+  MAX_VALUE,
+};
+
+enum class RateState {
+  Open,
+  Warned,
+  Throttled,
+  MAX_VALUE,
+};
+
+constexpr auto connTable =
+    sm::TransitionTable<TState, TEvent>{}
+        .enable(TState::Idle, TState::Active, TEvent::Start)
+        .enable(TState::Active, TState::Stopped, TEvent::Timeout)
+        .enable(TState::Active, TState::Canceled, TEvent::Cancel)
+        .enable(TState::Stopped, TState::Idle, TEvent::Restart)
+        .enable(TState::Canceled, TState::Idle, TEvent::Restart);
+
+constexpr auto authTable =
+    sm::TransitionTable<AuthState, TEvent>{}
+        .enable(AuthState::Anonymous, AuthState::Authenticated, TEvent::Start)
+        .enable(AuthState::Authenticated, AuthState::Anonymous,
+                TEvent::Cancel);
+
+constexpr auto rateTable =
+    sm::TransitionTable<RateState, TEvent>{}
+        .enable(RateState::Open, RateState::Warned, TEvent::Timeout)
+        .enable(RateState::Warned, RateState::Throttled, TEvent::Timeout)
+        .enable(RateState::Warned, RateState::Open, TEvent::Restart)
+        .enable(RateState::Throttled, RateState::Open, TEvent::Restart);
+
+using Parallel = sm::ParallelFSM<sm::TransitionTable<TState, TEvent>,
+                                 sm::TransitionTable<AuthState, TEvent>,
+                                 sm::TransitionTable<RateState, TEvent>>;
+using Fused = sm::StaticParallelFSM<connTable, authTable, rateTable>;
+
+static_assert(sizeof(Parallel::Packed) == 1, "2+1+2 bits pack into a byte");
+static_assert(sizeof(Fused) == 1, "Fused machine stores only the word");
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Every region sees every event
+  {
+    Parallel p(connTable, authTable, rateTable, TState::Idle,
+               AuthState::Anonymous, RateState::Open);
+    auto r = p.processEvent(TEvent::Start);
+    ts.expect_true(r.has_value() && *r == p.packed(),
+                   "processEvent returns the packed word");
+    ts.expect_eq(p.state<0>(), TState::Active, "Region 0 moved");
+    ts.expect_eq(p.state<1>(), AuthState::Authenticated, "Region 1 moved");
+    ts.expect_eq(p.state<2>(), RateState::Open, "Region 2 kept its state");
+  }
+
+  // Test 2: An event no region handles is rejected and changes nothing
+  {
+    Parallel p(connTable, authTable, rateTable, TState::Idle,
+               AuthState::Anonymous, RateState::Open);
+    const auto before = p.packed();
+    auto r = p.processEvent(TEvent::Cancel);
+    ts.expect_true(!r.has_value() &&
+                       r.error() == sm::ProcessEventErr::NoNextStateFound,
+                   "Unhandled event reports NoNextStateFound");
+    ts.expect_eq(p.packed(), before, "Packed word unchanged");
+  }
+
+  // Test 3: Fused product table matches per-region machines step by step
+  {
+    sm::FSM<TState, TEvent> conn(TState::Idle);
+    sm::FSM<AuthState, TEvent> auth(AuthState::Anonymous);
+    sm::FSM<RateState, TEvent> rate(RateState::Open);
+    conn.init(connTable);
+    auth.init(authTable);
+    rate.init(rateTable);
+    Parallel p(connTable, authTable, rateTable, TState::Idle,
+               AuthState::Anonymous, RateState::Open);
+    Fused f(TState::Idle, AuthState::Anonymous, RateState::Open);
+
+    std::mt19937 rng(7);
+    bool same = true;
+    bool sameResult = true;
+    for (int i = 0; i < 10000; ++i) {
+      const auto ev = static_cast<TEvent>(rng() % 4);
+      const bool moved = conn.processEvent(ev).has_value() |
+                         auth.processEvent(ev).has_value() |
+                         rate.processEvent(ev).has_value();
+      const auto rp = p.processEvent(ev);
+      const auto rf = f.processEvent(ev);
+      sameResult = sameResult && rp.has_value() == moved &&
+                   rf.has_value() == moved;
+      same = same && p.packed() == f.packed() &&
+             f.state<0>() == conn.getCurrentState() &&
+             f.state<1>() == auth.getCurrentState() &&
+             f.state<2>() == rate.getCurrentState();
+    }
+    ts.expect_true(same, "Parallel, fused and separate FSMs agree");
+    ts.expect_true(sameResult, "All report the same accept/reject");
+    ts.expect_eq(Fused::fusedCellCount(), std::size_t{32 * 4},
+                 "Product table has 2^5 words x 4 events");
+  }
+
+  // Test 4: Fused table is usable in constant expressions
+  {
+    constexpr auto end = [] {
+      Fused f(TState::Idle, AuthState::Anonymous, RateState::Open);
+      (void)f.processEvent(TEvent::Start);
+      (void)f.processEvent(TEvent::Timeout);
+      return f.packed();
+    }();
+    ts.expect_eq(Parallel::unpack<0>(end), TState::Stopped,
+                 "constexpr step: connection Stopped");
+    ts.expect_eq(Parallel::unpack<2>(end), RateState::Warned,
+                 "constexpr step: rate limiter Warned");
+    ts.expect_eq(end, Parallel::pack(TState::Stopped, AuthState::Authenticated,
+                                     RateState::Warned),
+                 "pack() inverts unpack()");
+  }
+
+  return ts.summary();
+}
@@ -0,0 +1,246 @@
+// Tests for PmrFunction and memory_resource-backed FSM callback storage.
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <expected>
+#include <functional>
+#include <memory_resource>
+#include <new>
+#include <print>
+#include <utility>
+#include <vector>
+
+#include <state_machine/EdgeTransitionTable.hpp>
+#include <state_machine/MachineDefinition.hpp>
+#include <state_machine/PmrFunction.hpp>
+#include <state_machine/StateMachine.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+// Counts global heap allocations, to check that arena-backed machines make
+// none.
+static std::size_t globalAllocations = 0;
+
+void *operator new(std::size_t size) {
+  ++globalAllocations;
+  if (void *p = std::malloc(size != 0 ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+// Forwards to an upstream resource and counts what passes through.
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  explicit CountingResource(std::pmr::memory_resource *upstream)
+      : upstream_(upstream) {}
+
+  std::size_t allocations = 0;
+  std::size_t deallocations = 0;
+
+ private:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++allocations;
+    return upstream_->allocate(bytes, alignment);
+  }
+  void do_deallocate(void *p, std::size_t bytes,
+                     std::size_t alignment) override {
+    ++deallocations;
+    upstream_->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+  std::pmr::memory_resource *upstream_;
+};
+
+enum class PState {
+  Idle,
+  Busy,
+  MAX_VALUE,
+};
+
+enum class PEvent {
+  Go,
+  Back,
+  MAX_VALUE,
+};
+
+using Fn = sm::PmrFunction<int(int)>;
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Small targets are inline, large ones use the resource
+  {
+    CountingResource counting(std::pmr::new_delete_resource());
+    Fn small([](int x) { return x + 1; }, &counting);
+    ts.expect_eq(small(1), 2, "Small target callable");
+    ts.expect_eq(counting.allocations, std::size_t{0}, "Small target inline");
+
+    std::array<int, 32> big{};
+    big[31] = 5;
+    {
+      Fn large([big](int x) { return x + big[31]; }, &counting);
+      ts.expect_eq(large(1), 6, "Large target callable");
+      ts.expect_eq(counting.allocations, std::size_t{1},
+                   "Large target allocated from the resource");
+    }
+    ts.expect_eq(counting.deallocations, std::size_t{1},
+                 "Large target returned to the resource");
+  }
+
+  // Test 2: Empty inputs, moves and copies
+  {
+    CountingResource counting(std::pmr::new_delete_resource());
+    ts.expect_true(!Fn(std::function<int(int)>{}), "Empty std::function");
+    ts.expect_true(!Fn(static_cast<int (*)(int)>(nullptr)), "Null pointer");
+    ts.expect_true(!Fn(), "Default is empty");
+
+    std::array<int, 32> big{};
+    Fn a([big](int x) { return x * 2; }, &counting);
+    Fn b(std::move(a));
+    ts.expect_true(!a && b && b(4) == 8, "Move transfers the target");
+    ts.expect_eq(counting.allocations, std::size_t{1}, "Move never allocates");
+    ts.expect_true(b.resource() == &counting, "Move keeps the resource");
+
+    Fn c(b);
+    ts.expect_true(c(3) == 6 &&
+                       c.resource() == std::pmr::get_default_resource(),
+                   "Copy uses the default resource");
+    Fn d(b, &counting);
+    ts.expect_eq(counting.allocations, std::size_t{2},
+                 "Copy into a resource allocates there");
+
+    Fn e(&counting);
+    e = c;
+    ts.expect_true(e.resource() == &counting && e(1) == 2,
+                   "Copy assignment keeps the target's resource");
+    e = std::move(c);
+    ts.expect_true(e.resource() == std::pmr::get_default_resource(),
+                   "Move assignment takes the source's resource");
+
+    Fn f;
+    f = b;
+    ts.expect_true(f(5) == 10 &&
+                       f.resource() == std::pmr::get_default_resource(),
+                   "Copy assignment into a default wrapper copies the target");
+    f = d;
+    ts.expect_eq(f(6), 12, "Copy assignment replaces a heap target");
+    f = Fn();
+    ts.expect_true(!f, "Assigning an empty wrapper frees the heap target");
+
+    bool threw = false;
+    try {
+      (void)Fn()(1);
+    } catch (const std::bad_function_call &) {
+      threw = true;
+    }
+    ts.expect_true(threw, "Calling an empty function throws");
+  }
+
+  // Test 3: An arena-backed FSM makes no global allocations
+  {
+    std::array<std::byte, 16384> buffer{};
+    std::pmr::monotonic_buffer_resource arena(
+        buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    int entered = 0;
+    std::array<int, 32> context{};
+
+    bool inArena = false;
+    const auto before = globalAllocations;
+    {
+      sm::FSM<PState, PEvent> fsm(PState::Idle, &arena);
+      fsm.init();
+      fsm.enableTransition(PState::Idle, PState::Busy, PEvent::Go);
+      fsm.enableTransition(PState::Busy, PState::Idle, PEvent::Back);
+      for (int i = 0; i < 8; ++i) {
+        fsm.attachOnEnterStateCallback(
+            PState::Busy, [&entered, context](sm::TransitionType, PState,
+                                              PState, PEvent) {
+              entered += 1 + context[0];
+            });
+      }
+      fsm.attachTransitionGuard(
+          PState::Busy, [context](PState, PState, PEvent) {
+            return context[31] == 0;
+          });
+      (void)fsm.processEvent(PEvent::Go);
+      (void)fsm.processEvent(PEvent::Back);
+      auto moved = std::move(fsm);
+      (void)moved.processEvent(PEvent::Go);
+      inArena = moved.resource() == &arena;
+    }
+    // Sampled before the TestSuite calls below, which allocate themselves.
+    const auto after = globalAllocations;
+    ts.expect_true(inArena, "Machine reports its arena");
+    ts.expect_eq(after, before, "Machine storage came from the arena only");
+    ts.expect_eq(entered, 16, "Callbacks ran from the arena");
+  }
+
+  // Test 4: Copies leave the arena; minimize() keeps it
+  {
+    CountingResource counting(std::pmr::new_delete_resource());
+    sm::FSM<PState, PEvent> fsm(PState::Idle, &counting);
+    fsm.init();
+    fsm.enableTransition(PState::Idle, PState::Busy, PEvent::Go);
+    fsm.attachOnExitStateCallback(PState::Idle,
+                                  [](sm::TransitionType, PState, PState,
+                                     PEvent) {});
+    const auto used = counting.allocations;
+    ts.expect_true(used > 0, "Callback buffer allocated from the resource");
+
+    auto copy = fsm;
+    ts.expect_true(copy.resource() == std::pmr::get_default_resource(),
+                   "Copy uses the default resource");
+    ts.expect_eq(counting.allocations, used, "Copy did not touch the arena");
+
+    (void)fsm.minimize();
+    ts.expect_true(fsm.resource() == &counting,
+                   "Minimized definition stays in the resource");
+    ts.expect_eq(fsm.processEvent(PEvent::Go).value_or(PState::MAX_VALUE),
+                 PState::Busy, "Minimized machine still runs");
+  }
+
+  // Test 5: Value-returning callables are accepted where void is stored
+  {
+    int entered = 0;
+    int actions = 0;
+    sm::FSM<PState, PEvent> fsm(PState::Idle);
+    fsm.init();
+    fsm.enableTransition(PState::Idle, PState::Busy, PEvent::Go);
+    fsm.attachOnEnterStateCallback(
+        PState::Busy, [&](auto, auto, auto, auto) { return ++entered; });
+    fsm.attachTransitionGuard(PState::Idle,
+                              [](PState, PState, PEvent) { return 1; });
+    ts.expect_eq(fsm.processEvent(PEvent::Go).value_or(PState::MAX_VALUE),
+                 PState::Busy, "Int-returning guard allows the transition");
+    ts.expect_eq(entered, 1, "Value-returning callback ran");
+
+    using EdgeTable = sm::EdgeTransitionTable<PState, PEvent>;
+    sm::MachineDefinition<PState, PEvent, EdgeTable> def;
+    const auto action =
+        def.addEdgeAction([&](PState, PState, PEvent) { return ++actions; });
+    def.enableTransition(PState::Idle, PState::Busy, PEvent::Go,
+                         sm::NoEdgeHook, action);
+    def.attachOnEnterStateCallback(
+        PState::Busy,
+        [&](sm::TransitionType, PState, PState, PEvent) { return &entered; });
+    sm::FSMInstance<PState, PEvent, EdgeTable> instance(def, PState::Idle);
+    (void)instance.processEvent(PEvent::Go);
+    ts.expect_eq(actions, 1, "Value-returning edge action ran");
+
+    sm::PmrFunction<void(int)> discard([](int x) { return x * 2; });
+    discard(3);
+    ts.expect_true(static_cast<bool>(discard), "Result discarded for void");
+  }
+
+  return ts.summary();
+}
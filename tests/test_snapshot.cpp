@@ -0,0 +1,214 @@
+// Tests for table/state snapshots, TransitionTableView and MappedSnapshot.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <expected>
+#include <fstream>
+#include <print>
+#include <string>
+#include <vector>
+
+#include <state_machine/FSMPool.hpp>
+#include <state_machine/Snapshot.hpp>
+#include <state_machine/StateMachine.hpp>
+#include <state_machine/TransitionTable.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class SState : std::uint8_t {
+  Idle,
+  Active,
+  Done,
+  MAX_VALUE,
+};
+
+enum class SEvent : std::uint8_t {
+  Start,
+  Stop,
+  MAX_VALUE,
+};
+
+enum class WideState : std::uint16_t {
+  MAX_VALUE = 300,
+};
+
+using Table = sm::TransitionTable<SState, SEvent>;
+using NibbleTable =
+    sm::TransitionTable<SState, SEvent, sm::TableEncoding::Nibble>;
+
+constexpr std::uint64_t Tag = 0x5eed;
+
+constexpr Table makeTable() {
+  return Table{}
+      .enable(SState::Idle, SState::Active, SEvent::Start)
+      .enable(SState::Active, SState::Done, SEvent::Stop);
+}
+
+// Viewing a constexpr table works in constant expressions too.
+static_assert(sm::TransitionTableView<SState, SEvent>(makeTable())
+                  .lookup(SState::Idle, SEvent::Start) == SState::Active);
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: A table round-trips and the view reads the snapshot in place
+  {
+    const auto blob = sm::snapshotTable(makeTable(), Tag);
+    ts.expect_eq(blob.size(), std::size_t{64 + Table::CellCount},
+                 "Header plus raw cells");
+    const auto view = sm::loadTable<SState, SEvent>(blob, Tag);
+    ts.expect_true(view.has_value(), "Snapshot loads");
+    ts.expect_true(reinterpret_cast<const std::byte *>(view->data()) ==
+                       blob.data() + 64,
+                   "View points into the snapshot");
+    ts.expect_eq(view->lookup(SState::Idle, SEvent::Start), SState::Active,
+                 "Lookup through the view");
+    ts.expect_eq(view->lookup(SState::Done, SEvent::Start), SState::MAX_VALUE,
+                 "Missing transition through the view");
+    ts.expect_true(view->table() == makeTable(), "Owning copy is equal");
+    ts.expect_true(sm::verifySnapshot(blob).has_value(), "Checksum matches");
+
+    sm::FSM<SState, SEvent> fsm(SState::Idle);
+    fsm.init(view->table());
+    ts.expect_eq(fsm.processEvent(SEvent::Start).value_or(SState::MAX_VALUE),
+                 SState::Active, "FSM runs the loaded table");
+  }
+
+  // Test 2: Nibble tables keep their packing
+  {
+    NibbleTable table{};
+    table.enable(SState::Active, SState::Idle, SEvent::Stop);
+    const auto blob = sm::snapshotTable(table);
+    const auto view =
+        sm::loadTable<SState, SEvent, sm::TableEncoding::Nibble>(blob);
+    ts.expect_true(view && view->lookup(SState::Active, SEvent::Stop) ==
+                               SState::Idle,
+                   "Nibble table loads");
+    ts.expect_eq(sm::loadTable<SState, SEvent>(blob).error(),
+                 sm::SnapshotErr::LayoutMismatch,
+                 "Nibble snapshot is not a Narrow table");
+  }
+
+  // Test 3: Header mismatches are reported
+  {
+    const auto blob = sm::snapshotTable(makeTable(), Tag);
+    ts.expect_eq(sm::loadTable<SState, SEvent>(blob, Tag + 1).error(),
+                 sm::SnapshotErr::TagMismatch, "Wrong tag");
+    ts.expect_eq(sm::loadTable<WideState, SEvent>(blob, Tag).error(),
+                 sm::SnapshotErr::LayoutMismatch, "Wrong state type");
+    ts.expect_eq(sm::loadStates<SState>(blob, Tag).error(),
+                 sm::SnapshotErr::LayoutMismatch, "Table is not states");
+    const auto shortBlob = std::span(blob).first(blob.size() - 1);
+    ts.expect_eq(sm::loadTable<SState, SEvent>(shortBlob, Tag).error(),
+                 sm::SnapshotErr::Truncated, "Truncated payload");
+    ts.expect_eq(
+        sm::loadTable<SState, SEvent>(std::span(blob).first(10), Tag).error(),
+        sm::SnapshotErr::Truncated, "Truncated header");
+
+    auto corrupt = blob;
+    corrupt.back() ^= std::byte{1};
+    ts.expect_eq(sm::verifySnapshot(corrupt).error(),
+                 sm::SnapshotErr::ChecksumMismatch, "Corruption detected");
+
+    auto badMagic = blob;
+    badMagic[0] = std::byte{'X'};
+    ts.expect_eq(sm::loadTable<SState, SEvent>(badMagic, Tag).error(),
+                 sm::SnapshotErr::BadMagic, "Bad magic");
+
+    auto swapped = blob;
+    std::swap(swapped[8], swapped[11]);
+    ts.expect_eq(sm::loadTable<SState, SEvent>(swapped, Tag).error(),
+                 sm::SnapshotErr::ByteOrderMismatch, "Foreign byte order");
+
+    // Shifted by one byte: the payload is no longer aligned for 2-byte
+    // states.
+    const std::vector<WideState> wide(4, WideState{7});
+    const auto wideBlob = sm::snapshotStates<WideState>(wide);
+    std::vector<std::byte> shifted(wideBlob.size() + 1);
+    std::copy(wideBlob.begin(), wideBlob.end(), shifted.begin() + 1);
+    ts.expect_eq(
+        sm::loadStates<WideState>(std::span(shifted).subspan(1)).error(),
+        sm::SnapshotErr::Misaligned, "Misaligned payload");
+  }
+
+  // Test 4: Pool states round-trip
+  {
+    sm::FSMPool<SState, SEvent> pool(makeTable(), 1000, SState::Idle);
+    std::vector<SEvent> events(1000, SEvent::Start);
+    pool.step(std::span(events).first(500));
+    const auto blob = sm::snapshotStates(pool.states(), Tag);
+    const auto states = sm::loadStates<SState>(blob, Tag);
+    ts.expect_true(states && states->size() == 1000, "States load");
+    ts.expect_true(reinterpret_cast<const std::byte *>(states->data()) ==
+                       blob.data() + 64,
+                   "States are read in place");
+
+    sm::FSMPool<SState, SEvent> restored(makeTable(), 0, SState::Idle);
+    restored.assign(*states);
+    ts.expect_true(restored.size() == 1000 &&
+                       restored.getState(499) == SState::Active &&
+                       restored.getState(500) == SState::Idle,
+                   "Pool restored from snapshot");
+  }
+
+  // Test 5: Snapshots load from a memory-mapped file
+  {
+    const std::string path = "state_machine_test_snapshot.bin";
+    {
+      const auto blob = sm::snapshotTable(makeTable(), Tag);
+      std::ofstream out(path, std::ios::binary);
+      out.write(reinterpret_cast<const char *>(blob.data()),
+                static_cast<std::streamsize>(blob.size()));
+    }
+    auto file = sm::MappedSnapshot::open(path.c_str());
+    ts.expect_true(file.has_value(), "File maps");
+    const auto view = sm::loadTable<SState, SEvent>(file->bytes(), Tag);
+    ts.expect_true(view && view->lookup(SState::Active, SEvent::Stop) ==
+                               SState::Done,
+                   "Mapped table is usable");
+    sm::MappedSnapshot moved = std::move(*file);
+    ts.expect_true(moved.bytes().size() == 64 + Table::CellCount &&
+                       file->bytes().empty(),
+                   "Mapping moves");
+    std::remove(path.c_str());
+
+    ts.expect_true(!sm::MappedSnapshot::open("/nonexistent/snapshot.bin"),
+                   "Missing file reported");
+  }
+
+  // Test 6: Out-of-range values are rejected even with a valid checksum
+  {
+    auto bad = makeTable();
+    bad.cells[1] = 3; // the sentinel: still a valid "no transition"
+    ts.expect_true(sm::loadTable<SState, SEvent>(sm::snapshotTable(bad)) &&
+                       sm::verifySnapshot(sm::snapshotTable(bad)),
+                   "Sentinel cells are accepted");
+    bad.cells[1] = 7;
+    const auto blob = sm::snapshotTable(bad);
+    ts.expect_eq(sm::loadTable<SState, SEvent>(blob).error(),
+                 sm::SnapshotErr::ValueOutOfRange, "Loader rejects the cell");
+    ts.expect_eq(sm::verifySnapshot(blob).error(),
+                 sm::SnapshotErr::ValueOutOfRange, "Verify rejects the cell");
+
+    NibbleTable nibble{};
+    nibble.cells[0] = 0xE0;
+    const auto nibbleBlob = sm::snapshotTable(nibble);
+    ts.expect_eq(
+        sm::loadTable<SState, SEvent, sm::TableEncoding::Nibble>(nibbleBlob)
+            .error(),
+        sm::SnapshotErr::ValueOutOfRange, "Nibble cells are range-checked");
+    ts.expect_eq(sm::verifySnapshot(nibbleBlob).error(),
+                 sm::SnapshotErr::ValueOutOfRange,
+                 "Verify range-checks nibble cells");
+
+    const std::vector<SState> states{SState::Idle, SState::MAX_VALUE};
+    ts.expect_eq(sm::verifySnapshot(sm::snapshotStates<SState>(states)).error(),
+                 sm::SnapshotErr::ValueOutOfRange,
+                 "Verify rejects a state that is not a state");
+  }
+
+  return ts.summary();
+}
@@ -0,0 +1,123 @@
+// Tests for state_machine::SparseTransitionTable.
+
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <print>
+
+#include <state_machine/SparseTransitionTable.hpp>
+#include <state_machine/StateMachine.hpp>
+#include <state_machine/TransitionTable.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class TState {
+  Idle,
+  Active,
+  Stopped,
+  Canceled,
+  MAX_VALUE,
+};
+
+enum class TEvent {
+  Start,
+  Timeout,
+  Cancel,
+  Restart,
+  MAX_VALUE,
+};
+
+enum class ParserState : std::uint16_t { MAX_VALUE = 300 };
+enum class ParserEvent : std::uint16_t { MAX_VALUE = 200 };
+
+static_assert(sm::TransitionTableBackend<
+              sm::SparseTransitionTable<ParserState, ParserEvent>>);
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Sparse table matches a dense one under random edits
+  {
+    using Sparse = sm::SparseTransitionTable<ParserState, ParserEvent>;
+    using Dense = sm::TransitionTable<ParserState, ParserEvent>;
+    Sparse sparse{};
+    auto dense = std::make_unique<Dense>();
+
+    unsigned seed = 99;
+    const auto next = [&seed](unsigned bound) {
+      seed = seed * 1103515245u + 12345u;
+      return (seed >> 8) % bound;
+    };
+    for (int i = 0; i < 2000; ++i) {
+      const auto from = static_cast<ParserState>(next(300));
+      const auto to = static_cast<ParserState>(next(300));
+      const auto ev = static_cast<ParserEvent>(next(200));
+      if (next(4) == 0) {
+        sparse.disable(from, ev);
+        dense->disable(from, ev);
+      } else {
+        sparse.enable(from, to, ev);
+        dense->enable(from, to, ev);
+      }
+    }
+
+    bool same = true;
+    std::size_t defined = 0;
+    for (auto s : enum_utils::enum_values<ParserState>()) {
+      for (auto e : enum_utils::enum_values<ParserEvent>()) {
+        const auto expected = dense->lookup(s, e);
+        same = same && sparse.lookup(s, e) == expected;
+        defined += expected != ParserState::MAX_VALUE ? 1 : 0;
+      }
+    }
+    ts.expect_true(same, "Sparse lookups match dense table");
+    ts.expect_eq(sparse.size(), defined,
+                 "Sparse table stores only defined transitions");
+
+    sparse.clear();
+    ts.expect_eq(sparse.size(), std::size_t{0}, "clear() empties the table");
+    ts.expect_eq(sparse.lookup(ParserState{}, ParserEvent{}),
+                 ParserState::MAX_VALUE, "Cleared table has no transitions");
+  }
+
+  // Test 2: Re-enabling a cell overwrites instead of duplicating
+  {
+    sm::SparseTransitionTable<TState, TEvent> table{};
+    table.enable(TState::Idle, TState::Active, TEvent::Start);
+    table.enable(TState::Idle, TState::Stopped, TEvent::Start);
+    ts.expect_eq(table.size(), std::size_t{1}, "One entry after overwrite");
+    ts.expect_eq(table.lookup(TState::Idle, TEvent::Start), TState::Stopped,
+                 "Overwrite updates the target");
+  }
+
+  // Test 3: FSM with the sparse backend keeps full semantics
+  {
+    sm::FSM<TState, TEvent, sm::SparseTransitionTable<TState, TEvent>> fsm(
+        TState::Idle);
+    fsm.init();
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    fsm.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+    int entered = 0;
+    fsm.attachOnEnterStateCallback(
+        TState::Stopped,
+        [&](sm::TransitionType, TState, TState, TEvent) { ++entered; });
+
+    auto missing = fsm.processEvent(TEvent::Timeout);
+    ts.expect_true(!missing.has_value() &&
+                       missing.error() == sm::ProcessEventErr::NoNextStateFound,
+                   "Sparse FSM reports NoNextStateFound");
+    (void)fsm.processEvent(TEvent::Start);
+    (void)fsm.processEvent(TEvent::Timeout);
+    ts.expect_eq(fsm.getCurrentState(), TState::Stopped,
+                 "Sparse FSM walks Idle->Active->Stopped");
+    ts.expect_eq(entered, 1, "Sparse FSM runs Enter callback");
+
+    fsm.disableTransition(TState::Idle, TState::Active, TEvent::Start);
+    ts.expect_eq(fsm.definition().table().size(), std::size_t{1},
+                 "disableTransition removes the sparse entry");
+  }
+
+  return ts.summary();
+}
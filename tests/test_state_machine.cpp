@@ -5,11 +5,18 @@
 // StateMachine.hpp to work around any missing transitive includes while keeping
 // StateMachine.hpp unchanged.
 #include <expected>
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <optional>
 #include <print>
+#include <type_traits>
 #include <vector>
 
 #include <state_machine/StateMachine.hpp>
 
+#include "TestSuite.hpp"
+
 namespace sm = state_machine;
 
 // Test enums for states and events
@@ -29,32 +36,6 @@ enum class TEvent {
   MAX_VALUE,
 };
 
-struct TestSuite {
-  int passed = 0;
-  int failed = 0;
-
-  void expect_true(bool cond, std::string_view msg) {
-    if (cond) {
-      ++passed;
-      std::println("[PASS] {}", msg);
-    } else {
-      ++failed;
-      std::println("[FAIL] {}", msg);
-    }
-  }
-
-  template <typename T, typename U>
-  void expect_eq(const T &lhs, const U &rhs, std::string_view msg) {
-    if (lhs == rhs) {
-      ++passed;
-      std::println("[PASS] {}", msg);
-    } else {
-      ++failed;
-      std::println("[FAIL] {}", msg);
-    }
-  }
-};
-
 struct CallbackRecord {
   sm::TransitionType type;
   TState current;
@@ -274,6 +255,331 @@ int main() {
     auto r = fsm.processEvent(TEvent::Restart);
     ts.expect_true(!r.has_value(), "Guard blocks Restart transition");
   }
-  std::println("\nSummary: {} passed, {} failed", ts.passed, ts.failed);
-  return ts.failed == 0 ? 0 : 1;
+
+  // Test 12: processEvents walks a whole span and reports consumption
+  {
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.init();
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    fsm.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+    fsm.enableTransition(TState::Stopped, TState::Active, TEvent::Restart);
+
+    const std::array events{TEvent::Start, TEvent::Timeout, TEvent::Restart};
+    auto r = fsm.processEvents(events);
+    ts.expect_eq(r.consumed, std::size_t{3}, "Batch consumed all events");
+    ts.expect_eq(r.failed, std::size_t{0}, "Batch had no failures");
+    ts.expect_true(!r.firstError.has_value(), "Batch reports no error");
+    ts.expect_eq(fsm.getCurrentState(), TState::Active,
+                 "Batch ends in Active");
+  }
+
+  // Test 13: StopOnError stops at the first rejected event
+  {
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.init();
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    fsm.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+
+    const std::array events{TEvent::Start, TEvent::Restart, TEvent::Timeout};
+    auto r = fsm.processEvents(events, sm::BatchErrorPolicy::StopOnError);
+    ts.expect_eq(r.consumed, std::size_t{2},
+                 "StopOnError consumes up to the failing event");
+    ts.expect_eq(r.failed, std::size_t{1}, "StopOnError counts one failure");
+    ts.expect_true(r.firstError == sm::ProcessEventErr::NoNextStateFound,
+                   "StopOnError reports NoNextStateFound");
+    ts.expect_eq(fsm.getCurrentState(), TState::Active,
+                 "StopOnError leaves state at last success");
+  }
+
+  // Test 14: ContinueOnError keeps going and writes every resulting state
+  {
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.init();
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    fsm.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+
+    const std::array events{TEvent::Start, TEvent::Restart, TEvent::Timeout};
+    std::vector<TState> states;
+    auto r = fsm.processEvents(events, std::back_inserter(states),
+                               sm::BatchErrorPolicy::ContinueOnError);
+    ts.expect_eq(r.consumed, std::size_t{3},
+                 "ContinueOnError consumes all events");
+    ts.expect_eq(r.failed, std::size_t{1},
+                 "ContinueOnError counts the failure");
+    ts.expect_true(states == std::vector{TState::Active, TState::Active,
+                                         TState::Stopped},
+                   "Output iterator receives state after each event");
+  }
+
+  // Test 15: Batch with hooks still runs guards and callbacks per event
+  {
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.init();
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    fsm.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+    fsm.enableTransition(TState::Stopped, TState::Active, TEvent::Restart);
+
+    int entered = 0;
+    fsm.attachOnEnterStateCallback(
+        TState::Active,
+        [&](sm::TransitionType, TState, TState, TEvent) { ++entered; });
+    fsm.attachTransitionGuard(TState::Stopped,
+                              [](TState, TState, TEvent) { return false; });
+
+    const std::array events{TEvent::Start, TEvent::Timeout, TEvent::Restart};
+    auto r = fsm.processEvents(events);
+    ts.expect_eq(r.consumed, std::size_t{3}, "Hooked batch consumed all");
+    ts.expect_true(r.firstError == sm::ProcessEventErr::TransitionForbidden,
+                   "Hooked batch reports TransitionForbidden");
+    ts.expect_eq(entered, 1, "Enter callback ran once in batch");
+    ts.expect_eq(fsm.getCurrentState(), TState::Stopped,
+                 "Hooked batch stops in Stopped");
+  }
+
+  // Test 16: Replacing a guard with an empty one removes it
+  {
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.init();
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    fsm.attachTransitionGuard(TState::Idle,
+                              [](TState, TState, TEvent) { return false; });
+    auto blocked = fsm.processEvent(TEvent::Start);
+    ts.expect_true(!blocked.has_value(), "Guard blocks before removal");
+
+    fsm.attachTransitionGuard(TState::Idle, {});
+    auto r = fsm.processEvent(TEvent::Start);
+    ts.expect_true(r.has_value(), "Empty guard lets the transition through");
+    ts.expect_eq(fsm.getCurrentState(), TState::Active,
+                 "State is Active after guard removal");
+  }
+
+  // Test 17: Callbacks on unrelated states do not fire
+  {
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.init();
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    int fired = 0;
+    const auto count = [&fired](sm::TransitionType, TState, TState, TEvent) {
+      ++fired;
+    };
+    fsm.attachOnExitStateCallback(TState::Active, count);
+    fsm.attachOnEnterStateCallback(TState::Idle, count);
+    fsm.attachOnEnterStateCallback(TState::Stopped, count);
+    (void)fsm.processEvent(TEvent::Start);
+    ts.expect_eq(fired, 0, "Only callbacks of exited/entered states fire");
+  }
+
+  // Test 18: Events raised from callbacks are deferred (run-to-completion)
+  {
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.init();
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    fsm.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+    std::vector<TState> seenInEnter;
+    std::optional<sm::ProcessEventErr> nested;
+    int depth = 0;
+    int maxDepth = 0;
+    const auto enter = [&](sm::TransitionType, TState, TState next, TEvent) {
+      maxDepth = std::max(maxDepth, ++depth);
+      seenInEnter.push_back(fsm.getCurrentState());
+      if (next == TState::Active) {
+        nested = fsm.processEvent(TEvent::Timeout).error();
+        ts.expect_eq(fsm.getCurrentState(), TState::Active,
+                     "Deferred event does not run inside the callback");
+      }
+      --depth;
+    };
+    fsm.attachOnEnterStateCallback(TState::Active, enter);
+    fsm.attachOnEnterStateCallback(TState::Stopped, enter);
+
+    auto r = fsm.processEvent(TEvent::Start);
+    ts.expect_true(r.has_value() && *r == TState::Active,
+                   "Outer processEvent returns its own transition");
+    ts.expect_true(nested == sm::ProcessEventErr::Deferred,
+                   "Nested processEvent reports Deferred");
+    ts.expect_eq(fsm.getCurrentState(), TState::Stopped,
+                 "Deferred event ran after the outer transition");
+    ts.expect_eq(maxDepth, 1, "Callbacks never nest");
+    ts.expect_true(seenInEnter ==
+                       std::vector<TState>{TState::Active, TState::Stopped},
+                   "Each Enter callback sees its own committed state");
+  }
+
+  // Test 19: Long cascades run iteratively; overflow reports DeferredQueueFull
+  {
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.init();
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    fsm.enableTransition(TState::Active, TState::Idle, TEvent::Cancel);
+    int enters = 0;
+    int full = 0;
+    fsm.attachOnEnterStateCallback(
+        TState::Active, [&](sm::TransitionType, TState, TState, TEvent) {
+          if (++enters < 1000) {
+            (void)fsm.processEvent(TEvent::Cancel);
+          }
+        });
+    fsm.attachOnEnterStateCallback(
+        TState::Idle, [&](sm::TransitionType, TState, TState, TEvent) {
+          (void)fsm.processEvent(TEvent::Start);
+        });
+    (void)fsm.processEvent(TEvent::Start);
+    ts.expect_eq(enters, 1000, "Cascade of 2000 transitions completed");
+    ts.expect_eq(fsm.getCurrentState(), TState::Active,
+                 "Cascade ends in Active");
+
+    fsm.attachOnEnterStateCallback(TState::Idle, {});
+    fsm.attachOnExitStateCallback(
+        TState::Active, [&](sm::TransitionType, TState, TState, TEvent) {
+          for (std::size_t i = 0; i <= fsm.DeferredCapacity; ++i) {
+            if (fsm.processEvent(TEvent::Timeout).error() ==
+                sm::ProcessEventErr::DeferredQueueFull) {
+              ++full;
+            }
+          }
+        });
+    (void)fsm.processEvent(TEvent::Cancel);
+    ts.expect_eq(full, 1, "Event past DeferredCapacity is rejected");
+  }
+
+  // Test 20: Batch drains each event's cascade before the next event
+  {
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.init();
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    fsm.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+    fsm.enableTransition(TState::Stopped, TState::Idle, TEvent::Restart);
+    fsm.attachOnEnterStateCallback(
+        TState::Active, [&](sm::TransitionType, TState, TState, TEvent) {
+          (void)fsm.processEvent(TEvent::Timeout);
+        });
+
+    const std::array events{TEvent::Start, TEvent::Restart, TEvent::Start};
+    std::vector<TState> states;
+    auto r = fsm.processEvents(events, std::back_inserter(states));
+    ts.expect_true(r.consumed == 3 && r.failed == 0,
+                   "Batch with cascades consumed all events");
+    ts.expect_true(states == std::vector<TState>{TState::Stopped,
+                                                 TState::Idle,
+                                                 TState::Stopped},
+                   "Batch output reflects each cascade");
+  }
+
+  // Test 21: Machines are movable values and survive vector reallocation
+  {
+    using Machine = sm::FSM<TState, TEvent>;
+    static_assert(std::is_nothrow_move_constructible_v<Machine>);
+    static_assert(std::is_nothrow_move_assignable_v<Machine>);
+    static_assert(std::is_copy_constructible_v<Machine>);
+
+    // Counts copies of the callable itself; std::function moves never copy.
+    struct CountingCallback {
+      int *copies;
+      int *calls;
+      CountingCallback(int *copies, int *calls)
+          : copies(copies), calls(calls) {}
+      CountingCallback(const CountingCallback &other)
+          : copies(other.copies), calls(other.calls) {
+        ++*copies;
+      }
+      CountingCallback(CountingCallback &&) noexcept = default;
+      void operator()(sm::TransitionType, TState, TState, TEvent) const {
+        ++*calls;
+      }
+    };
+
+    int copies = 0;
+    int calls = 0;
+    std::vector<sm::FSM<TState, TEvent>> machines;
+    for (int i = 0; i < 100; ++i) {
+      sm::FSM<TState, TEvent> fsm(TState::Idle);
+      fsm.init();
+      fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+      fsm.attachOnEnterStateCallback(TState::Active,
+                                     CountingCallback(&copies, &calls));
+      machines.push_back(std::move(fsm));
+    }
+    const int copiesAfterBuild = copies;
+    std::reverse(machines.begin(), machines.end());
+    machines.shrink_to_fit();
+    ts.expect_eq(copies, copiesAfterBuild,
+                 "Reallocation and reordering copy no callbacks");
+    for (auto &fsm : machines) {
+      (void)fsm.processEvent(TEvent::Start);
+    }
+    ts.expect_eq(calls, 100, "Every moved machine runs its callback");
+
+    auto copy = machines.front();
+    ts.expect_eq(copy.getCurrentState(), TState::Active, "Copy keeps state");
+    copy.enableTransition(TState::Active, TState::Idle, TEvent::Cancel);
+    (void)copy.processEvent(TEvent::Cancel);
+    ts.expect_true(copy.getCurrentState() == TState::Idle &&
+                       !machines.front().processEvent(TEvent::Cancel),
+                   "Copies are independent");
+  }
+
+  // Test 22: A copy taken from a callback does not inherit the dispatch
+  {
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.init();
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    fsm.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+    std::optional<sm::FSM<TState, TEvent>> snapshot;
+    fsm.attachOnEnterStateCallback(
+        TState::Active, [&](sm::TransitionType, TState, TState, TEvent) {
+          (void)fsm.processEvent(TEvent::Timeout);
+          snapshot.emplace(fsm);
+        });
+    (void)fsm.processEvent(TEvent::Start);
+    ts.expect_eq(fsm.getCurrentState(), TState::Stopped,
+                 "Original drains its deferred event");
+    ts.expect_eq(snapshot->getCurrentState(), TState::Active,
+                 "Copy taken mid-transition");
+    snapshot->attachOnEnterStateCallback(TState::Active, {});
+    ts.expect_eq(snapshot->processEvent(TEvent::Timeout)
+                     .value_or(TState::MAX_VALUE),
+                 TState::Stopped, "Copy processes events normally");
+  }
+
+  // Test 23: Copy assignment of heap-stored guards and callbacks
+  {
+    int guards = 0;
+    int entered = 0;
+    {
+      // Captures too large for PmrFunction's inline buffer.
+      std::array<char, 64> context{};
+      context[63] = 1;
+      sm::FSM<TState, TEvent> a(TState::Idle);
+      a.init();
+      a.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+      a.attachTransitionGuard(
+          TState::Idle, [&guards, context](TState, TState, TEvent) {
+            guards += context[63];
+            return true;
+          });
+      a.attachOnEnterStateCallback(
+          TState::Active,
+          [&entered, context](sm::TransitionType, TState, TState, TEvent) {
+            entered += context[63];
+          });
+
+      sm::FSM<TState, TEvent> b(TState::Stopped);
+      b = a;
+      ts.expect_eq(b.getCurrentState(), TState::Idle,
+                   "Copy assignment takes the state");
+      (void)b.processEvent(TEvent::Start);
+      ts.expect_true(b.getCurrentState() == TState::Active && guards == 1 &&
+                         entered == 1,
+                     "Copy-assigned machine runs the source's hooks");
+      (void)a.processEvent(TEvent::Start);
+      ts.expect_true(guards == 2 && entered == 2,
+                     "Source keeps its own hooks");
+      b = a;
+      ts.expect_eq(b.getCurrentState(), TState::Active,
+                   "Copy assignment over existing hooks");
+    }
+    ts.expect_eq(entered, 2, "Both machines destruct cleanly");
+  }
+
+  return ts.summary();
 }
@@ -0,0 +1,148 @@
+// Tests for state_machine::SwitchFSM against StaticFSM.
+
+#include <cstdint>
+#include <expected>
+#include <print>
+#include <random>
+#include <vector>
+
+#include <state_machine/StaticStateMachine.hpp>
+#include <state_machine/SwitchStateMachine.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class TState {
+  Idle,
+  Active,
+  Stopped,
+  Canceled,
+  MAX_VALUE,
+};
+
+enum class TEvent {
+  Start,
+  Timeout,
+  Cancel,
+  Restart,
+  MAX_VALUE,
+};
+
+constexpr auto kTable =
+    sm::TransitionTable<TState, TEvent>{}
+        .enable(TState::Idle, TState::Active, TEvent::Start)
+        .enable(TState::Active, TState::Stopped, TEvent::Timeout)
+        .enable(TState::Active, TState::Canceled, TEvent::Cancel)
+        .enable(TState::Active, TState::Active, TEvent::Restart)
+        .enable(TState::Stopped, TState::Active, TEvent::Restart)
+        .enable(TState::Canceled, TState::Idle, TEvent::Restart);
+
+struct Record {
+  char kind;
+  TState from;
+  TState to;
+  TEvent event;
+
+  bool operator==(const Record &) const = default;
+};
+
+struct RecordingHooks {
+  std::vector<Record> *log;
+  bool allow = true;
+
+  bool guard(TState from, TState to, TEvent event) {
+    log->push_back({'G', from, to, event});
+    return allow;
+  }
+  void onExit(TState from, TState to, TEvent event) {
+    log->push_back({'X', from, to, event});
+  }
+  void onEnter(TState from, TState to, TEvent event) {
+    log->push_back({'N', from, to, event});
+  }
+};
+
+// Usable in constant expressions like StaticFSM.
+constexpr TState runToStopped() {
+  sm::SwitchFSM<kTable> fsm(TState::Idle);
+  (void)fsm.processEvent(TEvent::Start);
+  (void)fsm.processEvent(TEvent::Restart);
+  (void)fsm.processEvent(TEvent::Timeout);
+  return fsm.getCurrentState();
+}
+static_assert(runToStopped() == TState::Stopped);
+static_assert(sizeof(sm::SwitchFSM<kTable>) == sizeof(TState));
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Same results and states as StaticFSM on a random stream
+  {
+    sm::StaticFSM<kTable> reference(TState::Idle);
+    sm::SwitchFSM<kTable> fsm(TState::Idle);
+    std::mt19937 rng(7);
+    std::size_t mismatches = 0;
+    std::size_t accepted = 0;
+    for (int i = 0; i < 10'000; ++i) {
+      const auto event = static_cast<TEvent>(rng() % 4);
+      const auto expected = reference.processEvent(event);
+      const auto actual = fsm.processEvent(event);
+      if (expected != actual ||
+          reference.getCurrentState() != fsm.getCurrentState()) {
+        ++mismatches;
+      }
+      accepted += actual.has_value() ? 1 : 0;
+    }
+    ts.expect_eq(mismatches, std::size_t{0}, "SwitchFSM matches StaticFSM");
+    ts.expect_true(accepted > 0, "Stream exercises transitions");
+
+    sm::SwitchFSM<kTable> idle(TState::Idle);
+    const auto missing = idle.processEvent(TEvent::Timeout);
+    ts.expect_true(!missing.has_value() &&
+                       missing.error() == sm::ProcessEventErr::NoNextStateFound,
+                   "Empty cell reports NoNextStateFound");
+    ts.expect_eq(idle.getCurrentState(), TState::Idle,
+                 "Empty cell leaves the state unchanged");
+  }
+
+  // Test 2: Hooks run in order with the constant states and event
+  {
+    std::vector<Record> log;
+    sm::SwitchFSM<kTable, RecordingHooks> fsm(TState::Idle,
+                                              RecordingHooks{&log});
+    (void)fsm.processEvent(TEvent::Start);
+    (void)fsm.processEvent(TEvent::Cancel);
+    const std::vector<Record> expected{
+        {'G', TState::Idle, TState::Active, TEvent::Start},
+        {'X', TState::Idle, TState::Active, TEvent::Start},
+        {'N', TState::Idle, TState::Active, TEvent::Start},
+        {'G', TState::Active, TState::Canceled, TEvent::Cancel},
+        {'X', TState::Active, TState::Canceled, TEvent::Cancel},
+        {'N', TState::Active, TState::Canceled, TEvent::Cancel},
+    };
+    ts.expect_true(log == expected, "Guard, exit, enter per transition");
+
+    log.clear();
+    (void)fsm.processEvent(TEvent::Start);
+    ts.expect_true(log.empty(), "No hooks for an empty cell");
+  }
+
+  // Test 3: Guard hook forbids the transition
+  {
+    std::vector<Record> log;
+    sm::SwitchFSM<kTable, RecordingHooks> fsm(TState::Idle,
+                                              RecordingHooks{&log, false});
+    const auto r = fsm.processEvent(TEvent::Start);
+    ts.expect_true(!r.has_value() &&
+                       r.error() == sm::ProcessEventErr::TransitionForbidden,
+                   "Guard hook yields TransitionForbidden");
+    ts.expect_eq(fsm.getCurrentState(), TState::Idle,
+                 "State unchanged when guard hook blocks");
+    ts.expect_eq(log.size(), std::size_t{1}, "No callbacks after blocked guard");
+    ts.expect_true(sm::SwitchFSM<kTable>::table() == kTable,
+                   "table() exposes the compiled table");
+  }
+
+  return ts.summary();
+}
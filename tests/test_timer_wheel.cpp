@@ -0,0 +1,173 @@
+// Tests for state_machine::TimerWheel, StateTimeouts and TimedFSM.
+
+#include <cstdint>
+#include <expected>
+#include <print>
+#include <vector>
+
+#include <state_machine/StateMachine.hpp>
+#include <state_machine/TimerWheel.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class TState {
+  Idle,
+  Active,
+  Stopped,
+  Canceled,
+  MAX_VALUE,
+};
+
+enum class TEvent {
+  Start,
+  Timeout,
+  Cancel,
+  Restart,
+  MAX_VALUE,
+};
+
+namespace {
+
+// Records the tick each node fired at.
+struct Probe {
+  sm::TimerWheel *wheel;
+  std::vector<std::uint64_t> fired;
+
+  static void onExpire(sm::TimerNode &, void *context) {
+    auto &probe = *static_cast<Probe *>(context);
+    probe.fired.push_back(probe.wheel->now());
+  }
+};
+
+} // namespace
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Timers fire exactly at their deadline on every level
+  {
+    sm::TimerWheel wheel(5);
+    Probe probe{&wheel, {}};
+    const std::vector<std::uint64_t> deadlines{
+        6, 63, 64, 70, 4096, 4096 + 65, 262'144 + 3, (1ULL << 24) + 12};
+    std::vector<sm::TimerNode> nodes;
+    nodes.reserve(deadlines.size());
+    for (const auto deadline : deadlines) {
+      nodes.emplace_back(&Probe::onExpire, &probe);
+      wheel.arm(nodes.back(), deadline);
+    }
+    ts.expect_eq(wheel.size(), deadlines.size(), "All timers armed");
+
+    std::size_t fired = 0;
+    for (std::uint64_t t = 5; t <= (1ULL << 24) + 20; t += 997) {
+      fired += wheel.advance(t);
+    }
+    fired += wheel.advance((1ULL << 24) + 20);
+    ts.expect_eq(fired, deadlines.size(), "advance() reports every expiry");
+    ts.expect_true(probe.fired == deadlines,
+                   "Each timer fires at its deadline, in order");
+    ts.expect_eq(wheel.size(), std::size_t{0}, "Fired timers are disarmed");
+    ts.expect_true(!nodes.front().armed(), "Node reports disarmed");
+  }
+
+  // Test 2: Cancel, re-arm, past deadlines and moves
+  {
+    sm::TimerWheel wheel;
+    Probe probe{&wheel, {}};
+    sm::TimerNode a(&Probe::onExpire, &probe);
+    sm::TimerNode b(&Probe::onExpire, &probe);
+    wheel.armAfter(a, 10);
+    wheel.armAfter(b, 20);
+    a.cancel();
+    ts.expect_eq(wheel.size(), std::size_t{1}, "Cancel removes the timer");
+    wheel.arm(b, 15);
+    ts.expect_eq(wheel.size(), std::size_t{1}, "Re-arming does not duplicate");
+
+    sm::TimerNode moved(std::move(b));
+    ts.expect_true(moved.armed() && !b.armed(), "Move takes the wheel slot");
+    (void)wheel.advance(30);
+    ts.expect_true(probe.fired == std::vector<std::uint64_t>{15},
+                   "Moved timer fires at the re-armed deadline");
+
+    wheel.arm(a, 3);
+    (void)wheel.advance(31);
+    ts.expect_eq(probe.fired.back(), std::uint64_t{31},
+                 "Past deadlines fire on the next tick");
+
+    {
+      sm::TimerNode scoped(&Probe::onExpire, &probe);
+      wheel.armAfter(scoped, 5);
+    }
+    ts.expect_eq(wheel.size(), std::size_t{0}, "Destroyed timers cancel");
+    ts.expect_eq(wheel.advance(1000), std::size_t{0}, "Nothing left to fire");
+    ts.expect_eq(wheel.now(), std::uint64_t{1000}, "Empty wheel jumps ahead");
+  }
+
+  // Test 3: State timeouts re-arm on entry and cancel on exit
+  {
+    sm::TimerWheel wheel;
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    fsm.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+    fsm.enableTransition(TState::Active, TState::Active, TEvent::Restart);
+    fsm.enableTransition(TState::Active, TState::Canceled, TEvent::Cancel);
+    fsm.enableTransition(TState::Canceled, TState::Idle, TEvent::Restart);
+    const auto timeouts = sm::StateTimeouts<TState, TEvent>{}.after(
+        TState::Active, 30, TEvent::Timeout);
+
+    sm::TimedFSM machine(fsm, wheel, timeouts);
+    ts.expect_true(!machine.timer().armed(), "Idle has no timeout");
+    (void)machine.processEvent(TEvent::Start);
+    ts.expect_eq(machine.timer().deadline(), std::uint64_t{30},
+                 "Entering Active arms the timeout");
+
+    (void)wheel.advance(20);
+    (void)machine.processEvent(TEvent::Restart);
+    ts.expect_eq(machine.timer().deadline(), std::uint64_t{50},
+                 "A self-transition restarts the timeout");
+    (void)wheel.advance(49);
+    ts.expect_eq(machine.getCurrentState(), TState::Active,
+                 "No timeout before the deadline");
+    (void)wheel.advance(50);
+    ts.expect_eq(machine.getCurrentState(), TState::Stopped,
+                 "Timeout event fires at the deadline");
+    ts.expect_true(!machine.timer().armed(), "Stopped has no timeout");
+
+    sm::TimedFSM other(fsm, wheel, timeouts);
+    (void)other.processEvent(TEvent::Start);
+    (void)other.processEvent(TEvent::Cancel);
+    ts.expect_eq(wheel.size(), std::size_t{0}, "Leaving early cancels");
+  }
+
+  // Test 4: Many machines in a vector time out in one batch
+  {
+    sm::TimerWheel wheel;
+    sm::MachineDefinition<TState, TEvent> def;
+    def.enableTransition(TState::Idle, TState::Active, TEvent::Start);
+    def.enableTransition(TState::Active, TState::Stopped, TEvent::Timeout);
+    const auto timeouts = sm::StateTimeouts<TState, TEvent>{}.after(
+        TState::Active, 100, TEvent::Timeout);
+
+    using Timed = sm::TimedFSM<sm::FSMInstance<TState, TEvent>>;
+    std::vector<Timed> machines;
+    for (int i = 0; i < 1000; ++i) {
+      machines.emplace_back(sm::FSMInstance(def, TState::Idle), wheel,
+                            timeouts);
+      (void)machines.back().processEvent(TEvent::Start);
+    }
+    ts.expect_eq(wheel.size(), std::size_t{1000},
+                 "Timers survive vector reallocation");
+    ts.expect_eq(wheel.advance(99), std::size_t{0}, "Nothing due before 100");
+    ts.expect_eq(wheel.advance(100), std::size_t{1000},
+                 "Every timeout fires in the tick-100 batch");
+    std::size_t stopped = 0;
+    for (const auto &m : machines) {
+      stopped += m.getCurrentState() == TState::Stopped ? 1 : 0;
+    }
+    ts.expect_eq(stopped, std::size_t{1000}, "Every machine timed out");
+  }
+
+  return ts.summary();
+}
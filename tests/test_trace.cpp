@@ -0,0 +1,192 @@
+// Tests for TraceBuffer, TraceInstrumentation and decodeTrace().
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <print>
+#include <vector>
+
+#include <state_machine/StateMachine.hpp>
+#include <state_machine/Trace.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class TState {
+  Off,
+  On,
+  Broken,
+  MAX_VALUE,
+};
+
+enum class TEvent {
+  Toggle,
+  Break,
+  MAX_VALUE,
+};
+
+enum class OtherState {
+  Only,
+  MAX_VALUE,
+};
+
+using Buffer = sm::TraceBuffer<TState, TEvent, 8>;
+using Tracing = sm::TraceInstrumentation<TState, TEvent, 8>;
+using TracedFSM =
+    sm::FSM<TState, TEvent, sm::TransitionTable<TState, TEvent>, Tracing>;
+
+static void configure(TracedFSM &fsm) {
+  fsm.init();
+  fsm.enableTransition(TState::Off, TState::On, TEvent::Toggle);
+  fsm.enableTransition(TState::On, TState::Off, TEvent::Toggle);
+  fsm.enableTransition(TState::On, TState::Broken, TEvent::Break);
+}
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Transitions and rejections are recorded in order
+  {
+    Buffer trace{};
+    TracedFSM fsm(TState::Off, Tracing(trace));
+    configure(fsm);
+    (void)fsm.processEvent(TEvent::Toggle);
+    (void)fsm.processEvent(TEvent::Break);
+    (void)fsm.processEvent(TEvent::Toggle);
+    ts.expect_eq(trace.size(), std::size_t{3}, "Three records");
+
+    const auto blob = trace.dump();
+    ts.expect_eq(blob.size(), std::size_t{32 + (3 * 16)},
+                 "Header plus 16 bytes per record");
+    const auto decoded = sm::decodeTrace<TState, TEvent>(blob);
+    ts.expect_true(decoded.has_value(), "Dump decodes");
+    const auto &entries = decoded->entries;
+    ts.expect_eq(entries.size(), std::size_t{3}, "Three entries decoded");
+    ts.expect_true(entries[0].from == TState::Off &&
+                       entries[0].to == TState::On &&
+                       entries[0].event == TEvent::Toggle && !entries[0].error,
+                   "First transition decoded");
+    ts.expect_true(entries[1].from == TState::On &&
+                       entries[1].to == TState::Broken,
+                   "Second transition decoded");
+    ts.expect_true(entries[2].error == sm::ProcessEventErr::NoNextStateFound &&
+                       entries[2].from == TState::Broken &&
+                       entries[2].to == TState::Broken,
+                   "Rejection decoded with its error");
+    ts.expect_true(entries[0].timestamp <= entries[1].timestamp &&
+                       entries[1].timestamp <= entries[2].timestamp,
+                   "Timestamps are monotonic");
+    ts.expect_eq(decoded->recorded, std::uint64_t{3}, "Recorded count kept");
+    ts.expect_eq(decoded->clock, sm::DefaultTraceClock, "Default clock");
+  }
+
+  // Test 2: Guard rejections carry TransitionForbidden
+  {
+    Buffer trace{};
+    TracedFSM fsm(TState::Off, Tracing(trace));
+    configure(fsm);
+    fsm.attachTransitionGuard(TState::Off,
+                              [](TState, TState, TEvent) { return false; });
+    (void)fsm.processEvent(TEvent::Toggle);
+    const auto decoded = sm::decodeTrace<TState, TEvent>(trace.dump());
+    ts.expect_true(decoded && decoded->entries.size() == 1 &&
+                       decoded->entries[0].error ==
+                           sm::ProcessEventErr::TransitionForbidden,
+                   "Forbidden transition recorded");
+  }
+
+  // Test 3: The ring keeps only the most recent Capacity records
+  {
+    Buffer trace{};
+    TracedFSM fsm(TState::Off, Tracing(trace));
+    configure(fsm);
+    for (int i = 0; i < 11; ++i) {
+      (void)fsm.processEvent(TEvent::Toggle);
+    }
+    ts.expect_eq(trace.size(), std::size_t{8}, "Ring is full");
+    ts.expect_eq(trace.recorded(), std::uint64_t{11}, "All writes counted");
+    const auto decoded = sm::decodeTrace<TState, TEvent>(trace.dump());
+    ts.expect_eq(decoded->entries.size(), std::size_t{8}, "Capacity entries");
+    // Write k (0-based) starts from On when k is odd; writes 3..10 remain.
+    ts.expect_eq(decoded->entries.front().from, TState::On,
+                 "Oldest retained record is write 3");
+    ts.expect_eq(decoded->entries.back().from, TState::Off,
+                 "Newest record is write 10");
+    trace.clear();
+    ts.expect_eq(trace.size(), std::size_t{0}, "Clear empties the ring");
+  }
+
+  // Test 4: Batches are traced per event
+  {
+    Buffer trace{};
+    TracedFSM fsm(TState::Off, Tracing(trace));
+    configure(fsm);
+    const std::array events{TEvent::Toggle, TEvent::Toggle, TEvent::Break};
+    (void)fsm.processEvents(events, sm::BatchErrorPolicy::ContinueOnError);
+    ts.expect_eq(trace.size(), std::size_t{3}, "One record per batch event");
+  }
+
+  // Test 5: Malformed dumps are rejected
+  {
+    Buffer trace{};
+    TracedFSM fsm(TState::Off, Tracing(trace));
+    configure(fsm);
+    (void)fsm.processEvent(TEvent::Toggle);
+    (void)fsm.processEvent(TEvent::Break);
+    auto blob = trace.dump();
+
+    const auto shortBlob = std::span(blob).first(blob.size() - 1);
+    ts.expect_eq(sm::decodeTrace<TState, TEvent>(shortBlob).error(),
+                 sm::TraceDecodeErr::Truncated, "Truncated record");
+    ts.expect_eq(sm::decodeTrace<TState, TEvent>(std::span(blob).first(10))
+                     .error(),
+                 sm::TraceDecodeErr::Truncated, "Truncated header");
+    ts.expect_eq(sm::decodeTrace<OtherState, TEvent>(blob).error(),
+                 sm::TraceDecodeErr::StateOutOfRange,
+                 "States outside the enum rejected");
+
+    auto badVersion = blob;
+    badVersion[4] = std::byte{9};
+    ts.expect_eq(sm::decodeTrace<TState, TEvent>(badVersion).error(),
+                 sm::TraceDecodeErr::UnsupportedVersion, "Unknown version");
+
+    blob[0] = std::byte{'X'};
+    ts.expect_eq(sm::decodeTrace<TState, TEvent>(blob).error(),
+                 sm::TraceDecodeErr::BadMagic, "Bad magic");
+  }
+
+  // Test 6: Sequence clock stamps records with their index
+  {
+    using SeqBuffer =
+        sm::TraceBuffer<TState, TEvent, 4, sm::TraceClock::Sequence>;
+    using SeqTracing =
+        sm::TraceInstrumentation<TState, TEvent, 4, sm::TraceClock::Sequence>;
+    SeqBuffer trace{};
+    sm::FSM<TState, TEvent, sm::TransitionTable<TState, TEvent>, SeqTracing>
+        fsm(TState::Off, SeqTracing(trace));
+    fsm.init();
+    fsm.enableTransition(TState::Off, TState::On, TEvent::Toggle);
+    fsm.enableTransition(TState::On, TState::Off, TEvent::Toggle);
+    for (int i = 0; i < 6; ++i) {
+      (void)fsm.processEvent(TEvent::Toggle);
+    }
+    const auto decoded = sm::decodeTrace<TState, TEvent>(trace.dump());
+    ts.expect_eq(decoded->clock, sm::TraceClock::Sequence, "Clock recorded");
+    ts.expect_true(decoded->entries.front().timestamp == 2 &&
+                       decoded->entries.back().timestamp == 5,
+                   "Timestamps are sequence numbers");
+  }
+
+  // Test 7: An empty buffer dumps a bare header
+  {
+    Buffer trace{};
+    const auto decoded = sm::decodeTrace<TState, TEvent>(trace.dump());
+    ts.expect_true(decoded && decoded->entries.empty() &&
+                       decoded->recorded == 0,
+                   "Empty trace round-trips");
+  }
+
+  return ts.summary();
+}
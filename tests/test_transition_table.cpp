@@ -0,0 +1,175 @@
+// Tests for state_machine::TransitionTable and StaticFSM.
+
+#include <cstdint>
+#include <expected>
+#include <print>
+#include <type_traits>
+
+#include <state_machine/StateMachine.hpp>
+#include <state_machine/StaticStateMachine.hpp>
+#include <state_machine/TransitionTable.hpp>
+
+#include "TestSuite.hpp"
+
+namespace sm = state_machine;
+
+enum class TState {
+  Idle,
+  Active,
+  Stopped,
+  Canceled,
+  MAX_VALUE,
+};
+
+enum class TEvent {
+  Start,
+  Timeout,
+  Cancel,
+  Restart,
+  MAX_VALUE,
+};
+
+constexpr auto kTable = sm::TransitionTable<TState, TEvent>{}
+                            .enable(TState::Idle, TState::Active, TEvent::Start)
+                            .enable(TState::Active, TState::Stopped,
+                                    TEvent::Timeout)
+                            .enable(TState::Active, TState::Canceled,
+                                    TEvent::Cancel)
+                            .enable(TState::Stopped, TState::Active,
+                                    TEvent::Restart);
+
+// The whole table is usable in constant expressions.
+static_assert(kTable.lookup(TState::Idle, TEvent::Start) == TState::Active);
+static_assert(kTable.lookup(TState::Idle, TEvent::Cancel) ==
+              TState::MAX_VALUE);
+
+constexpr TState runStatic() {
+  sm::StaticFSM<kTable> fsm(TState::Idle);
+  (void)fsm.processEvent(TEvent::Start);
+  (void)fsm.processEvent(TEvent::Timeout);
+  return fsm.getCurrentState();
+}
+static_assert(runStatic() == TState::Stopped);
+static_assert(sizeof(sm::StaticFSM<kTable>) == sizeof(TState));
+
+// Cells use the narrowest index type regardless of the enum's underlying
+// type; nibble encoding packs two cells per byte.
+static_assert(std::is_same_v<sm::TransitionTable<TState, TEvent>::Cell,
+                             std::uint8_t>);
+static_assert(sizeof(sm::TransitionTable<TState, TEvent>) == 16);
+static_assert(
+    sizeof(sm::TransitionTable<TState, TEvent, sm::TableEncoding::Nibble>) ==
+    8);
+
+enum class WideState : std::uint32_t { MAX_VALUE = 300 };
+static_assert(std::is_same_v<enum_utils::enum_index_t<WideState>,
+                             std::uint16_t>);
+
+constexpr auto kNibbleTable =
+    sm::TransitionTable<TState, TEvent, sm::TableEncoding::Nibble>{}
+        .enable(TState::Idle, TState::Active, TEvent::Start)
+        .enable(TState::Active, TState::Stopped, TEvent::Timeout);
+
+constexpr TState runNibble() {
+  sm::StaticFSM<kNibbleTable> fsm(TState::Idle);
+  (void)fsm.processEvent(TEvent::Start);
+  (void)fsm.processEvent(TEvent::Timeout);
+  return fsm.getCurrentState();
+}
+static_assert(runNibble() == TState::Stopped);
+
+int main() {
+  TestSuite ts{};
+
+  // Test 1: Default-constructed table has no transitions
+  {
+    sm::TransitionTable<TState, TEvent> table{};
+    bool allEmpty = true;
+    for (auto s : enum_utils::enum_values<TState>()) {
+      for (auto e : enum_utils::enum_values<TEvent>()) {
+        allEmpty = allEmpty && table.lookup(s, e) == TState::MAX_VALUE;
+      }
+    }
+    ts.expect_true(allEmpty, "Empty table holds MAX_VALUE everywhere");
+  }
+
+  // Test 2: enable/disable/clear
+  {
+    sm::TransitionTable<TState, TEvent> table{};
+    table.enable(TState::Idle, TState::Active, TEvent::Start);
+    ts.expect_eq(table.lookup(TState::Idle, TEvent::Start), TState::Active,
+                 "enable() sets the cell");
+    table.disable(TState::Idle, TEvent::Start);
+    ts.expect_eq(table.lookup(TState::Idle, TEvent::Start), TState::MAX_VALUE,
+                 "disable() resets the cell");
+    table.enable(TState::Idle, TState::Active, TEvent::Start);
+    table.clear();
+    ts.expect_true(table == sm::TransitionTable<TState, TEvent>{},
+                   "clear() restores the empty table");
+  }
+
+  // Test 3: StaticFSM follows the compile-time table
+  {
+    sm::StaticFSM<kTable> fsm(TState::Idle);
+    auto r = fsm.processEvent(TEvent::Start);
+    ts.expect_true(r.has_value(), "StaticFSM defined transition succeeds");
+    ts.expect_eq(fsm.getCurrentState(), TState::Active,
+                 "StaticFSM state updated");
+
+    auto missing = fsm.processEvent(TEvent::Start);
+    ts.expect_true(!missing.has_value(), "StaticFSM missing transition fails");
+    if (!missing.has_value()) {
+      ts.expect_eq(missing.error(), sm::ProcessEventErr::NoNextStateFound,
+                   "StaticFSM error is NoNextStateFound");
+    }
+    ts.expect_eq(fsm.getCurrentState(), TState::Active,
+                 "StaticFSM state unchanged on error");
+  }
+
+  // Test 4: FSM::init(table) loads a prebuilt table and keeps hooks working
+  {
+    sm::FSM<TState, TEvent> fsm(TState::Idle);
+    fsm.init(kTable);
+    int entered = 0;
+    fsm.attachOnEnterStateCallback(
+        TState::Active,
+        [&](sm::TransitionType, TState, TState, TEvent) { ++entered; });
+
+    auto r1 = fsm.processEvent(TEvent::Start);
+    auto r2 = fsm.processEvent(TEvent::Cancel);
+    ts.expect_true(r1.has_value() && r2.has_value(),
+                   "FSM initialised from table transitions");
+    ts.expect_eq(fsm.getCurrentState(), TState::Canceled,
+                 "FSM reaches Canceled");
+    ts.expect_eq(entered, 1, "Enter callback fired once");
+  }
+
+  // Test 5: Nibble encoding round-trips every cell independently
+  {
+    sm::TransitionTable<TState, TEvent, sm::TableEncoding::Nibble> nibble{};
+    sm::TransitionTable<TState, TEvent> narrow{};
+    unsigned seed = 7;
+    for (int i = 0; i < 64; ++i) {
+      seed = seed * 1103515245u + 12345u;
+      const auto from = static_cast<TState>((seed >> 4) % 4);
+      const auto to = static_cast<TState>((seed >> 8) % 4);
+      const auto ev = static_cast<TEvent>((seed >> 12) % 4);
+      if ((seed >> 16) % 3 == 0) {
+        nibble.disable(from, ev);
+        narrow.disable(from, ev);
+      } else {
+        nibble.enable(from, to, ev);
+        narrow.enable(from, to, ev);
+      }
+    }
+    bool same = true;
+    for (auto st : enum_utils::enum_values<TState>()) {
+      for (auto e : enum_utils::enum_values<TEvent>()) {
+        same = same && nibble.lookup(st, e) == narrow.lookup(st, e);
+      }
+    }
+    ts.expect_true(same, "Nibble and narrow tables agree after edits");
+  }
+
+  return ts.summary();
+}